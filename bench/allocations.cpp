@@ -0,0 +1,117 @@
+// Heap allocations of Plan::step in steady state.
+// usage: bin/allocations_bench [num_of_plans] [num_of_steps]
+// Steps a warmed-up set of plans with every selection policy and counts the calls
+// of operator new in every step. Every facility type scores 1 life quality, so a
+// plan's life quality score is the number of facilities it completed. The only
+// allocations allowed are the slabs a FacilityPool opens every SLAB_SIZE completions,
+// a step in which no plan crossed a multiple of SLAB_SIZE has to allocate nothing.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "FacilityCatalogue.h"
+#include "Plan.h"
+#include "SelectionPolicy.h"
+#include "Settlement.h"
+using std::vector;
+
+static std::atomic<long long> numOfAllocations(0);
+
+void *operator new(size_t size)
+{
+    numOfAllocations++;
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+static const long long SLAB_SIZE = 256; // FacilityPool::SLAB_SIZE
+static const int WARM_UP_STEPS = 1000;
+
+// slabs a pool holding numOfFacilities facilities has opened
+static long long slabsFor(const long long numOfFacilities)
+{
+    return (numOfFacilities + SLAB_SIZE - 1) / SLAB_SIZE;
+}
+
+int main(int argc, char **argv)
+{
+    int numOfPlans = argc > 1 ? std::atoi(argv[1]) : 300;
+    int numOfSteps = argc > 2 ? std::atoi(argv[2]) : 5000;
+    std::shared_ptr<FacilityCatalogue> options = std::make_shared<FacilityCatalogue>();
+    for (int i = 0; i < 30; i++)
+        options->emplace_back(FacilityType("F" + std::to_string(i), FacilityCategory(i % 3), 1 + i % 5, 1, i % 4, (i * 7) % 5));
+    vector<Settlement*> settlements;
+    for (int i = 0; i < 3; i++)
+        settlements.emplace_back(new Settlement("S" + std::to_string(i), SettlementType(i)));
+    std::shared_ptr<const FacilityCatalogue> catalogue = options;
+    vector<Plan*> plans;
+    for (int i = 0; i < numOfPlans; i++)
+    {
+        SelectionPolicy *policy = nullptr;
+        if (i % 4 == 0)
+            policy = new NaiveSelection();
+        else if (i % 4 == 1)
+            policy = new BalancedSelection(0, 0, 0);
+        else if (i % 4 == 2)
+            policy = new EconomySelection();
+        else
+            policy = new SustainabilitySelection();
+        plans.emplace_back(new Plan(i, *settlements[i % 3], policy, catalogue));
+    }
+    for (int step = 0; step < WARM_UP_STEPS; step++)
+        for (Plan *plan : plans)
+            plan->step();
+
+    long long numOfCompleted = 0, numOfSlabs = 0, numOfAllocated = 0;
+    vector<long long> completed(plans.size());
+    for (size_t i = 0; i < plans.size(); i++)
+        completed[i] = plans[i]->getlifeQualityScore();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int step = 0; step < numOfSteps; step++)
+    {
+        long long before = numOfAllocations;
+        for (Plan *plan : plans)
+            plan->step();
+        long long allocations = numOfAllocations - before;
+        long long slabs = 0;
+        for (size_t i = 0; i < plans.size(); i++)
+        {
+            long long now = plans[i]->getlifeQualityScore();
+            slabs += slabsFor(now) - slabsFor(completed[i]);
+            numOfCompleted += now - completed[i];
+            completed[i] = now;
+        }
+        numOfSlabs += slabs;
+        numOfAllocated += allocations;
+        if ((slabs == 0) & (allocations > 0))
+        {
+            std::printf("step %d: %lld allocations without opening a slab\n", WARM_UP_STEPS + step, allocations);
+            return 1;
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::printf("plans: %d, steps: %d, facilities completed: %lld, ms: %lld\n", numOfPlans, numOfSteps, numOfCompleted,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()));
+    std::printf("slabs opened: %lld, allocations: %lld, none in any other step\n", numOfSlabs, numOfAllocated);
+    for (Plan *plan : plans)
+        delete plan;
+    for (Settlement *settlement : settlements)
+        delete settlement;
+    return 0;
+}
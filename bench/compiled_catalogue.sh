@@ -0,0 +1,48 @@
+#!/bin/sh
+# Startup time of a text config against the same config compiled with --compile-config.
+# usage: bench/compiled_catalogue.sh <simulation_binary> [num_of_settlements] [num_of_runs]
+# Generates a config with num_of_settlements settlements, as many plans and a few
+# facility types, compiles it once, checks that both start the same session, and
+# times the simulation from start until 'close' num_of_runs times with each.
+set -e
+sim=${1:?usage: bench/compiled_catalogue.sh <simulation_binary> [num_of_settlements] [num_of_runs]}
+numOfSettlements=${2:-1000000}
+numOfRuns=${3:-5}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk -v settlements="$numOfSettlements" 'BEGIN {
+    srand(1);
+    for (i = 0; i < settlements; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < settlements; i++) print "plan S" (i % 100), policy[1 + i % 4];
+}' > "$work/config.txt"
+begin=$(date +%s%N)
+"$sim" --compile-config "$work/config.txt" "$work/catalogue.bin"
+end=$(date +%s%N)
+compileMs=$(( (end - begin) / 1000000 ))
+echo close > "$work/close.txt"
+printf 'step 20\nplanStatus 7\nplanStatus %d\nclose\n' $((numOfSettlements - 1)) > "$work/session.txt"
+"$sim" "$work/config.txt" < "$work/session.txt" > "$work/text.txt"
+"$sim" "$work/catalogue.bin" < "$work/session.txt" > "$work/compiled.txt"
+cmp -s "$work/text.txt" "$work/compiled.txt" || { echo "the compiled catalogue starts a different session"; exit 1; }
+
+# median wall ms of numOfRuns runs starting from the file in $1
+timeRuns() {
+    run=0
+    while [ "$run" -lt "$numOfRuns" ]; do
+        begin=$(date +%s%N)
+        "$sim" "$1" < "$work/close.txt" > /dev/null
+        end=$(date +%s%N)
+        echo $(( (end - begin) / 1000000 ))
+        run=$((run + 1))
+    done | sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+echo "config: $(wc -c < "$work/config.txt") bytes, catalogue: $(wc -c < "$work/catalogue.bin") bytes, compiled in $compileMs ms, runs: $numOfRuns"
+echo "start from  median ms"
+text=$(timeRuns "$work/config.txt")
+compiled=$(timeRuns "$work/catalogue.bin")
+printf '%-10s  %d\n' text "$text" catalogue "$compiled"
+awk -v text="$text" -v compiled="$compiled" 'BEGIN { printf "speedup: %.2fx\n", text / compiled }'
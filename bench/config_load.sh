@@ -0,0 +1,47 @@
+#!/bin/sh
+# Startup time of a large text config.
+# usage: bench/config_load.sh <simulation_binary> [baseline_binary] [num_of_settlements] [num_of_runs]
+# Generates a config with num_of_settlements settlements, as many plans and a few
+# facility types, and times the simulation from start until 'close' num_of_runs times.
+# The plans are spread over the first 100 settlements, since versions before the
+# settlement index look every plan's settlement up by a scan from the start.
+# The session goes through stdin, so the binary of any earlier version can be given
+# as baseline_binary; its median is printed next to the other one.
+set -e
+sim=${1:?usage: bench/config_load.sh <simulation_binary> [baseline_binary] [num_of_settlements] [num_of_runs]}
+baseline=${2:-}
+numOfSettlements=${3:-1000000}
+numOfRuns=${4:-5}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk -v settlements="$numOfSettlements" 'BEGIN {
+    srand(1);
+    for (i = 0; i < settlements; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < settlements; i++) print "plan S" (i % 100), policy[1 + i % 4];
+}' > "$work/config.txt"
+echo close > "$work/close.txt"
+
+# median wall ms of numOfRuns runs of the binary in $1
+timeRuns() {
+    run=0
+    while [ "$run" -lt "$numOfRuns" ]; do
+        begin=$(date +%s%N)
+        "$1" "$work/config.txt" < "$work/close.txt" > /dev/null
+        end=$(date +%s%N)
+        echo $(( (end - begin) / 1000000 ))
+        run=$((run + 1))
+    done | sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+echo "config lines: $(wc -l < "$work/config.txt"), runs: $numOfRuns"
+echo "binary    median ms"
+current=$(timeRuns "$sim")
+printf '%-8s  %d\n' current "$current"
+if [ -n "$baseline" ]; then
+    before=$(timeRuns "$baseline")
+    printf '%-8s  %d\n' baseline "$before"
+    awk -v before="$before" -v after="$current" 'BEGIN { printf "speedup: %.2fx\n", before / after }'
+fi
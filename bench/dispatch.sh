@@ -0,0 +1,48 @@
+#!/bin/sh
+# Commands per second of the command front end.
+# usage: bench/dispatch.sh <simulation_binary> [baseline_binary] [num_of_commands] [num_of_runs]
+# Runs a generated --script of num_of_commands cheap commands (steps of a single plan,
+# new settlements, new facility types and policy changes) num_of_runs times and prints
+# the median time and commands per second. A second binary of any version with
+# --script can be given as baseline_binary to compare against.
+set -e
+sim=${1:?usage: bench/dispatch.sh <simulation_binary> [baseline_binary] [num_of_commands] [num_of_runs]}
+baseline=${2:-}
+numOfCommands=${3:-1000000}
+numOfRuns=${4:-5}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+printf 'settlement S0 0\nfacility F0 0 1 1 1 1\nfacility F1 1 2 1 2 1\nfacility F2 2 3 1 1 2\nplan S0 nve\n' > "$work/config.txt"
+awk -v commands="$numOfCommands" 'BEGIN {
+    for (i = 0; i < commands; i++) {
+        kind = i % 5;
+        if (kind == 1) print "settlement N" i, i % 3;
+        else if (kind == 2) print "facility G" i, i % 3, 1 + i % 5, i % 4, i % 3, i % 2;
+        else if (kind == 3) print "changePolicy 0", (int(i / 5) % 2) ? "nve" : "eco";
+        else print "step 1";
+    }
+    print "close";
+}' > "$work/commands.txt"
+
+# median wall ms of numOfRuns runs of the binary in $1
+timeRuns() {
+    run=0
+    while [ "$run" -lt "$numOfRuns" ]; do
+        begin=$(date +%s%N)
+        "$1" "$work/config.txt" --script "$work/commands.txt" > /dev/null
+        end=$(date +%s%N)
+        echo $(( (end - begin) / 1000000 ))
+        run=$((run + 1))
+    done | sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+echo "commands: $numOfCommands, runs: $numOfRuns"
+echo "binary    median ms  commands/s"
+current=$(timeRuns "$sim")
+printf '%-8s  %9d  %d\n' current "$current" $(( numOfCommands * 1000 / (current > 0 ? current : 1) ))
+if [ -n "$baseline" ]; then
+    before=$(timeRuns "$baseline")
+    printf '%-8s  %9d  %d\n' baseline "$before" $(( numOfCommands * 1000 / (before > 0 ? before : 1) ))
+    awk -v before="$before" -v after="$current" 'BEGIN { printf "speedup: %.2fx\n", before / after }'
+fi
@@ -0,0 +1,60 @@
+#!/bin/sh
+# Overhead of the write-ahead journal on the command path.
+# usage: bench/journal.sh <simulation_binary> [num_of_commands] [num_of_runs] [num_of_plans]
+# Runs the same generated script of cheap state-changing commands without a journal
+# and with --journal, alternating num_of_runs times, and prints the median time of
+# both and the overhead of the journal. The default config has few plans, so the
+# commands are cheap and the journal's share of their cost is as large as it gets. The journal is written next to the other
+# temporary files, so the cost of its fsyncs depends on that file system.
+set -e
+sim=${1:?usage: bench/journal.sh <simulation_binary> [num_of_commands] [num_of_runs] [num_of_plans]}
+numOfCommands=${2:-1000000}
+numOfRuns=${3:-11}
+numOfPlans=${4:-8}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk -v plans="$numOfPlans" 'BEGIN {
+    srand(1);
+    for (i = 0; i < 30; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < plans; i++) print "plan S" (i % 30), policy[1 + i % 4];
+}' > "$work/config.txt"
+# mostly steps, with settlements and policy changes in between, all of them journaled
+awk -v commands="$numOfCommands" -v plans="$numOfPlans" 'BEGIN {
+    for (i = 0; i < commands; i++) {
+        if (i % 10 == 9) print "settlement N" i, i % 3;
+        else if (i % 10 == 4) print "changePolicy", i % plans, (int(i / plans) % 2) ? "bal" : "eco";
+        else print "step 1";
+    }
+    print "close";
+}' > "$work/commands.txt"
+
+# journaled runs have to print exactly what plain runs print
+"$sim" "$work/config.txt" --script "$work/commands.txt" > "$work/plain.txt"
+"$sim" "$work/config.txt" --script "$work/commands.txt" --journal "$work/session.journal" > "$work/journaled.txt"
+cmp -s "$work/plain.txt" "$work/journaled.txt" || { echo "the journal changed the output"; exit 1; }
+journaled=$(wc -l < "$work/session.journal")
+
+run=0
+while [ "$run" -lt "$numOfRuns" ]; do
+    begin=$(date +%s%N)
+    "$sim" "$work/config.txt" --script "$work/commands.txt" > /dev/null
+    middle=$(date +%s%N)
+    rm -f "$work/session.journal"
+    "$sim" "$work/config.txt" --script "$work/commands.txt" --journal "$work/session.journal" > /dev/null
+    end=$(date +%s%N)
+    echo "$(( (middle - begin) / 1000000 )) $(( (end - middle) / 1000000 ))"
+    run=$((run + 1))
+done > "$work/times.txt"
+
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+plain=$(cut -d' ' -f1 "$work/times.txt" | median)
+withJournal=$(cut -d' ' -f2 "$work/times.txt" | median)
+echo "commands: $numOfCommands, journal records: $journaled, plans: $numOfPlans, runs: $numOfRuns, cpus: $(nproc)"
+echo "journal  median ms"
+printf '%7s  %d\n' off "$plain" on "$withJournal"
+awk -v plain="$plain" -v journal="$withJournal" 'BEGIN { printf "overhead: %.1f%%\n", 100 * (journal - plain) / plain }'
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Bulk plan creation.
+# usage: bench/plan_build.sh <simulation_binary> [baseline_binary] [num_of_plans] [num_of_runs]
+# Times two ways of creating num_of_plans plans over 100 settlements, num_of_runs times
+# each: a config holding the plans, run until 'close', and 'plan' commands run by
+# --replay on top of a config without plans. Prints the median time and plans per
+# second of both. A second binary of any version with --replay can be given as
+# baseline_binary to compare against.
+set -e
+sim=${1:?usage: bench/plan_build.sh <simulation_binary> [baseline_binary] [num_of_plans] [num_of_runs]}
+baseline=${2:-}
+numOfPlans=${3:-1000000}
+numOfRuns=${4:-5}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk 'BEGIN {
+    srand(1);
+    for (i = 0; i < 100; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+}' > "$work/empty.txt"
+awk -v plans="$numOfPlans" 'BEGIN {
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < plans; i++) print "plan S" (i % 100), policy[1 + i % 4];
+}' > "$work/plans.txt"
+cat "$work/empty.txt" "$work/plans.txt" > "$work/config.txt"
+echo close > "$work/close.txt"
+echo close >> "$work/plans.txt"
+
+# median wall ms of numOfRuns runs of the command line in the arguments
+timeRuns() {
+    run=0
+    while [ "$run" -lt "$numOfRuns" ]; do
+        begin=$(date +%s%N)
+        "$@" < "$work/close.txt" > /dev/null
+        end=$(date +%s%N)
+        echo $(( (end - begin) / 1000000 ))
+        run=$((run + 1))
+    done | sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+# prints the config and replay rows of the binary in $2, labelled $1
+timeBinary() {
+    config=$(timeRuns "$2" "$work/config.txt")
+    replay=$(timeRuns "$2" "$work/empty.txt" --replay "$work/plans.txt")
+    printf '%-8s  %-6s  %9d  %d\n' "$1" config "$config" $(( numOfPlans * 1000 / (config > 0 ? config : 1) ))
+    printf '%-8s  %-6s  %9d  %d\n' "$1" replay "$replay" $(( numOfPlans * 1000 / (replay > 0 ? replay : 1) ))
+}
+
+echo "plans: $numOfPlans, runs: $numOfRuns"
+echo "binary    from    median ms  plans/s"
+timeBinary current "$sim"
+if [ -n "$baseline" ]; then
+    timeBinary baseline "$baseline"
+fi
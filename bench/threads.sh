@@ -0,0 +1,35 @@
+#!/bin/sh
+# Thread-scaling benchmark of Simulation::step.
+# usage: bench/threads.sh <simulation_binary> [max_threads] [num_of_plans] [num_of_steps]
+# Generates a config with num_of_plans plans over a mixed catalogue, runs the same
+# step script with --threads 1..max_threads, prints the time of every run and checks
+# that every thread count prints the same result as one thread.
+set -e
+sim=${1:?usage: bench/threads.sh <simulation_binary> [max_threads] [num_of_plans] [num_of_steps]}
+maxThreads=${2:-$(nproc)}
+numOfPlans=${3:-20000}
+numOfSteps=${4:-2000}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk -v plans="$numOfPlans" 'BEGIN {
+    srand(1);
+    for (i = 0; i < 30; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < plans; i++) print "plan S" (i % 30), policy[1 + i % 4];
+}' > "$work/config.txt"
+# single steps, so every tick goes through the thread pool
+awk -v steps="$numOfSteps" 'BEGIN { for (i = 0; i < steps; i++) print "step 1"; print "close" }' > "$work/steps.txt"
+
+echo "plans: $numOfPlans, steps: $numOfSteps, cpus: $(nproc)"
+echo "threads  ms"
+threads=1
+while [ "$threads" -le "$maxThreads" ]; do
+    begin=$(date +%s%N)
+    "$sim" "$work/config.txt" --threads "$threads" --script "$work/steps.txt" > "$work/out$threads.txt"
+    end=$(date +%s%N)
+    printf '%7d  %d\n' "$threads" $(( (end - begin) / 1000000 ))
+    cmp -s "$work/out1.txt" "$work/out$threads.txt" || { echo "threads $threads: output differs from 1 thread"; exit 1; }
+    threads=$((threads + 1))
+done
@@ -16,9 +16,12 @@ class BaseAction{
         virtual void act(Simulation& simulation)=0;
         virtual const string toString() const=0;
         virtual BaseAction* clone() const = 0;
+        virtual ActionRecord toRecord() const = 0; // the action as an actions log entry
+        static BaseAction *fromRecord(const ActionRecord &record); // rebuilds a logged action with its status
         virtual ~BaseAction() = default;
 
     protected:
+        ActionRecord newRecord(const CommandCode code) const;
         void complete();
         void error(string errorMsg);
         const string& getErrorMsg() const;
@@ -35,6 +38,7 @@ class SimulateStep : public BaseAction {
         SimulateStep(const int numOfSteps);
         void act(Simulation &simulation) override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
         SimulateStep *clone() const override;
     private:
         const int numOfSteps;
@@ -45,6 +49,7 @@ class AddPlan : public BaseAction {
         AddPlan(const string &settlementName, const string &selectionPolicy);
         void act(Simulation &simulation) override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
         AddPlan *clone() const override;
     private:
         const string settlementName;
@@ -58,6 +63,7 @@ class AddSettlement : public BaseAction {
         void act(Simulation &simulation) override;
         AddSettlement *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const string settlementName;
         const SettlementType settlementType;
@@ -71,6 +77,7 @@ class AddFacility : public BaseAction {
         void act(Simulation &simulation) override;
         AddFacility *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const string facilityName;
         const FacilityCategory facilityCategory;
@@ -87,6 +94,7 @@ class PrintPlanStatus: public BaseAction {
         void act(Simulation &simulation) override;
         PrintPlanStatus *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const int planId;
 };
@@ -98,6 +106,7 @@ class ChangePlanPolicy : public BaseAction {
         void act(Simulation &simulation) override;
         ChangePlanPolicy *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const int planId;
         const string newPolicy;
@@ -110,6 +119,7 @@ class PrintActionsLog : public BaseAction {
         void act(Simulation &simulation) override;
         PrintActionsLog *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
 };
 
@@ -119,24 +129,114 @@ class Close : public BaseAction {
         void act(Simulation &simulation) override;
         Close *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
 };
 
 class BackupSimulation : public BaseAction {
     public:
         BackupSimulation();
+        BackupSimulation(const string &backupName);
         void act(Simulation &simulation) override;
         BackupSimulation *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
+        const string backupName; // empty for the default backup
 };
 
 
 class RestoreSimulation : public BaseAction {
     public:
         RestoreSimulation();
+        RestoreSimulation(const string &backupName);
         void act(Simulation &simulation) override;
         RestoreSimulation *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
+        const string backupName; // empty for the default backup
+};
+
+
+class PrintBackups : public BaseAction {
+    public:
+        PrintBackups();
+        void act(Simulation &simulation) override;
+        PrintBackups *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+};
+
+
+class SetNumOfThreads : public BaseAction {
+    public:
+        SetNumOfThreads(const int numOfThreads);
+        void act(Simulation &simulation) override;
+        SetNumOfThreads *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const int numOfThreads;
+};
+
+
+class SaveSimulation : public BaseAction {
+    public:
+        SaveSimulation(const string &filePath);
+        void act(Simulation &simulation) override;
+        SaveSimulation *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string filePath;
+};
+
+
+class LoadSimulation : public BaseAction {
+    public:
+        LoadSimulation(const string &filePath);
+        void act(Simulation &simulation) override;
+        LoadSimulation *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string filePath;
+};
+
+
+class BackgroundSaveSimulation : public BaseAction {
+    public:
+        BackgroundSaveSimulation(const string &filePath);
+        void act(Simulation &simulation) override;
+        BackgroundSaveSimulation *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string filePath;
+};
+
+
+class PrintSaveStatus : public BaseAction {
+    public:
+        PrintSaveStatus();
+        void act(Simulation &simulation) override;
+        PrintSaveStatus *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+};
+
+
+// a log entry read back from a checkpoint, only its text survives
+class RecordedAction : public BaseAction {
+    public:
+        RecordedAction(const string &text);
+        void act(Simulation &simulation) override;
+        RecordedAction *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string text;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+enum class CommandCode {
+    STEP,
+    PLAN,
+    SETTLEMENT,
+    FACILITY,
+    PLAN_STATUS,
+    CHANGE_POLICY,
+    LOG,
+    CLOSE,
+    BACKUP,
+    RESTORE,
+    BACKUPS,
+    THREADS,
+    SAVE,
+    LOAD,
+    BGSAVE,
+    BGSTATUS,
+    RECORDED, // a log line read back from a checkpoint
+    UNKNOWN,
+};
+
+// One logged action in a fixed-size record. Strings are stored as NameTable ids.
+struct ActionRecord {
+    int16_t code; // CommandCode
+    int16_t status; // ActionStatus
+    int32_t values[6]; // the action's arguments, in constructor order
+};
+
+// The actions log as records in fixed-size chunks. Copies share the chunks, an
+// append only copies the last chunk when it is still shared, so a backup of the
+// log costs O(1). The text of an action is rendered when the log is printed.
+class ActionLog {
+    public:
+        ActionLog();
+        void append(const ActionRecord &record);
+        size_t size() const;
+        const ActionRecord &operator[](const size_t index) const;
+        const string toString(const size_t index) const; // the line the action printed in the log
+        void clear();
+
+    private:
+        static const size_t CHUNK_SIZE = 4096;
+        typedef vector<ActionRecord> Chunk;
+        typedef vector<std::shared_ptr<Chunk>> Table;
+        std::shared_ptr<Table> table;
+        size_t numOfRecords;
+};
@@ -1,10 +0,0 @@
-#pragma once
-#include <iostream>
-#include <vector>
-#include <sstream>
-#include <string>
-
-class Auxiliary{
-    public:
-        static std::vector<std::string> parseArguments(const std::string& line);
-};
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+using std::string;
+
+class Simulation;
+
+enum class BackgroundSaveState {
+    IDLE,
+    RUNNING,
+    DONE,
+    FAILED,
+};
+
+// Writes a checkpoint on its own thread. start() takes a copy-on-write snapshot
+// of the simulation, which costs about as much as a backup, and the writer thread
+// serializes that snapshot while the command loop keeps going. One save at a time.
+class BackgroundSave {
+    public:
+        BackgroundSave();
+        bool start(const Simulation &simulation, const string &filePath); // false if a save is still running
+        const string status() const;
+        void wait();
+        // RULE OF 5
+        ~BackgroundSave(); // destructor
+        BackgroundSave(const BackgroundSave& other) = delete; // copy constructor
+        BackgroundSave& operator=(const BackgroundSave& other) = delete; // copy assignment operator
+        BackgroundSave(BackgroundSave&& other) = delete; // move constructor
+        BackgroundSave& operator=(BackgroundSave&& other) = delete; // move assignment opertor
+
+    private:
+        void run();
+        std::thread writer;
+        Simulation *snapshot; // owned, released when the next save starts
+        string filePath;
+        std::atomic<BackgroundSaveState> state;
+        std::atomic<size_t> plansWritten;
+        std::atomic<size_t> numOfPlans;
+};
+
+extern BackgroundSave backgroundSave; // used by 'bgsave' and 'bgstatus'
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Facility.h"
+using std::string;
+using std::vector;
+
+// Binary checkpoint format, numbers in native byte order:
+//   header   : magic "SPLCKPT", version, offset of the type table
+//   body     : written by Simulation::save (catalogue, settlements, plans, log)
+//   type table: every facility type referenced by the body, by index
+// Facility types are written by index into the type table, the catalogue always
+// takes the first indices.
+class CheckpointWriter {
+    public:
+        CheckpointWriter(const string &filePath);
+        bool isOpen() const;
+        void putInt(const int32_t value);
+        void putLong(const int64_t value);
+        void putString(const string &value);
+        void putType(const FacilityType &type);
+        bool finish(); // writes the type table and patches the header
+
+    private:
+        static const size_t BUFFER_SIZE = 1 << 16;
+        void putBytes(const void *bytes, const size_t size);
+        void flush();
+        std::ofstream file;
+        vector<char> buffer;
+        std::unordered_map<int, int> typeIndexes; // FacilityType id -> index in the type table
+        vector<int> typeIds;
+        int64_t written;
+};
+
+// Reads a checkpoint through a read-only memory mapping of the whole file.
+// Every read is bounds checked; after a failed read isValid() is false and
+// all further reads return zeros.
+class CheckpointReader {
+    public:
+        CheckpointReader(const string &filePath);
+        static bool isCheckpoint(const string &filePath); // only looks at the magic
+        bool isValid() const;
+        int32_t getInt();
+        int64_t getLong();
+        string getString();
+        int32_t getCount(const size_t recordSize); // a number of records of at least recordSize bytes that fit in the rest of the file
+        int getTypeId(); // FacilityType id, -1 if the index is bad
+        size_t getRemaining() const; // bytes left after the read position
+        // RULE OF 5
+        ~CheckpointReader(); // destructor
+        CheckpointReader(const CheckpointReader& other) = delete; // copy constructor
+        CheckpointReader& operator=(const CheckpointReader& other) = delete; // copy assignment operator
+        CheckpointReader(CheckpointReader&& other) = delete; // move constructor
+        CheckpointReader& operator=(CheckpointReader&& other) = delete; // move assignment opertor
+
+    private:
+        bool getBytes(void *bytes, const size_t size);
+        bool readTypeTable(const size_t offset);
+        const char *data;
+        size_t size;
+        size_t position;
+        bool valid;
+        vector<int> typeIds; // index in the type table -> FacilityType id
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+using std::string;
+using std::vector;
+
+// A word of a config or command line, pointing into the buffer it was cut from.
+struct ConfigToken {
+    const char *begin;
+    size_t length;
+    bool equals(const char *word) const;
+    int toInt() const; // like stoi, throws std::invalid_argument / std::out_of_range
+    bool toInt(int &value) const; // same parsing, false instead of throwing
+    const string toString() const;
+};
+
+// Reads a config file through a read-only memory mapping. Lines are split into
+// tokens in place, so no string is built for a word unless the caller asks for one.
+class ConfigFile {
+    public:
+        ConfigFile(const string &filePath);
+        bool isOpen() const;
+        bool nextLine(vector<ConfigToken> &tokens); // skips empty lines and '#' comments
+        bool nextLine(vector<ConfigToken> &tokens, size_t &position, const size_t end) const; // same, inside [position, end)
+        vector<std::pair<size_t, size_t>> split(const size_t numOfChunks) const; // byte ranges cut at line ends
+        static void tokenize(const char *begin, const char *end, vector<ConfigToken> &tokens); // one line, replaces tokens
+        size_t countLines(const char *firstWord) const; // lines starting with firstWord, for pre-sizing
+        // RULE OF 5
+        ~ConfigFile(); // destructor
+        ConfigFile(const ConfigFile& other) = delete; // copy constructor
+        ConfigFile& operator=(const ConfigFile& other) = delete; // copy assignment operator
+        ConfigFile(ConfigFile&& other) = delete; // move constructor
+        ConfigFile& operator=(ConfigFile&& other) = delete; // move assignment opertor
+
+    private:
+        const char *data;
+        size_t size;
+        size_t position;
+        bool isFileOpen;
+};
@@ -16,32 +16,49 @@ enum class FacilityCategory {
 };
 
 
+// Facility types are flyweights: every distinct type is registered once in a
+// process-wide table and facilities refer to it by its id.
 class FacilityType {
     public:
         FacilityType(const string &name, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score);
         const string &getName() const;
+        int getNameId() const;
         int getCost() const;
         int getLifeQualityScore() const;
         int getEnvironmentScore() const;
         int getEconomyScore() const;
         FacilityCategory getCategory() const;
+        int getId() const;
+        static const FacilityType &fromId(const int id);
 
     protected:
-        const string name;
+        const int nameId; // id in NameTable
         const FacilityCategory category;
         const int price;
         const int lifeQuality_score;
         const int economy_score;
         const int environment_score;
+
+    private:
+        static int internType(const FacilityType &type);
+        int id; // id in the flyweight table
 };
 
 
 
-class Facility: public FacilityType {
+class Facility {
 
     public:
         Facility(const string &name, const string &settlementName, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score);
         Facility(const FacilityType &type, const string &settlementName);
+        Facility(const FacilityType &type, const int settlementId, const FacilityStatus status);
+        const FacilityType &getType() const;
+        const string &getName() const;
+        int getCost() const;
+        int getLifeQualityScore() const;
+        int getEnvironmentScore() const;
+        int getEconomyScore() const;
+        FacilityCategory getCategory() const;
         const string &getSettlementName() const;
         const int getTimeLeft() const;
         FacilityStatus step();
@@ -51,7 +68,8 @@ class Facility: public FacilityType {
 
     private:
         static string categoryToString(FacilityCategory category);
-        const string settlementName;
+        const int typeId; // id of the shared FacilityType
+        const int settlementId; // id of the settlement name in NameTable
         FacilityStatus status;
         int timeLeft;
 };
\ No newline at end of file
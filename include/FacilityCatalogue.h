@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "Facility.h"
+using std::vector;
+
+// The facility types a simulation offers, in the order they were added. Besides the
+// list it keeps indexes for the selection policies, updated on every append.
+// An append may reallocate the list, so plans keep indexes into it, not pointers.
+class FacilityCatalogue {
+    public:
+        FacilityCatalogue();
+        void emplace_back(const FacilityType &facility);
+        void reserve(const size_t capacity);
+        void clear();
+        size_t size() const;
+        bool empty() const;
+        const FacilityType &operator[](const size_t index) const;
+        const FacilityType *data() const;
+        vector<FacilityType>::const_iterator begin() const;
+        vector<FacilityType>::const_iterator end() const;
+        // index of the next type of category after index after, wrapping around,
+        // -1 if the catalogue has none. cursor is the caller's position in the
+        // category, it makes the common case of moving one ahead O(1)
+        int nextOfCategory(const FacilityCategory category, const int after, int &cursor) const;
+        // index of the first type that leaves the three scores closest together
+        // (smallest max - min) when added to them, -1 if the catalogue is empty
+        int mostBalanced(const int lifeQualityScore, const int economyScore, const int environmentScore) const;
+
+    private:
+        static const int NUM_OF_CATEGORIES = 3;
+        vector<FacilityType> options;
+        vector<int> categoryPositions[NUM_OF_CATEGORIES]; // ascending indexes of every category
+        // max - min of three scores only depends on (lifeQuality - economy, economy - environment),
+        // so the types are kept as points in that plane, one per distinct point with its first
+        // index, bucketed in square cells that are searched in rings around the query.
+        // The points are stored as columns in catalogue order, which the scans run over
+        static const int CELL_SIZE = 8;
+        static const size_t SCAN_POINTS = 64; // up to this many points are scanned without the cells
+        static long long key(const long long x, const long long y);
+        static long long cellOf(const long long coordinate);
+        int scanBalanced(const long long targetX, const long long targetY) const; // first index of the closest point
+        vector<int> balanceX; // lifeQuality - economy
+        vector<int> balanceY; // economy - environment
+        vector<int> balanceIndex; // first catalogue index at the point
+        std::unordered_map<long long, int> balancePointIds; // point -> position in the columns
+        std::unordered_map<long long, vector<int>> balanceCells; // cell -> positions in the columns
+        int minCellX;
+        int maxCellX;
+        int minCellY;
+        int maxCellY;
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Facility.h"
+using std::vector;
+
+// Slab storage for the operational facilities of one plan, in completion order.
+// Facilities are placed one after the other in fixed-size slabs and are only
+// destroyed all together, so a completion costs a placement new and no heap call
+// except once per SLAB_SIZE facilities.
+// A full slab never changes again, so copies of the pool share their full slabs and
+// only duplicate the last, partly filled one.
+class FacilityPool {
+    public:
+        FacilityPool();
+        const Facility &create(const FacilityType &type, const int settlementId, const FacilityStatus status);
+        void forEach(const std::function<void(const Facility&)> &visit) const;
+        void clear();
+        // RULE OF 5
+        ~FacilityPool() = default; // destructor
+        FacilityPool(const FacilityPool& other); // copy constructor
+        FacilityPool& operator=(const FacilityPool& other) = delete; // copy assignment operator
+        FacilityPool(FacilityPool&& other); // move constructor
+        FacilityPool& operator=(FacilityPool&& other) = delete; // move assignment opertor
+
+    private:
+        static const size_t SLAB_SIZE = 256;
+        struct Slab {
+            Slab();
+            ~Slab();
+            Slab(const Slab& other) = delete;
+            Slab& operator=(const Slab& other) = delete;
+            Facility *items; // raw memory for SLAB_SIZE facilities
+            size_t used;
+        };
+        void *nextSlot();
+        vector<std::shared_ptr<Slab>> slabs;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+using std::vector;
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Compact storage for operational facilities. The facilities are kept in order
+// as runs of one FacilityType id repeated count times, 8 bytes each, so even a
+// plan that never builds the same type twice in a row stays under the 16 bytes
+// of a Facility. Consecutive facilities of one type collapse into a single run,
+// and a whole repeating period of a plan is stored as one run of its pattern.
+class FacilityRuns {
+    public:
+        FacilityRuns();
+        void append(const int typeId);
+        void append(const vector<int> &pattern, const long long count);
+        void forEach(const std::function<void(int)> &visit) const;
+        void clear();
+        void save(CheckpointWriter &out) const;
+        bool load(CheckpointReader &in);
+        void sumScores(int &lifeQuality, int &economy, int &environment) const;
+        // RULE OF 5
+        ~FacilityRuns() = default; // destructor
+        FacilityRuns(const FacilityRuns& other); // copy constructor
+        FacilityRuns& operator=(const FacilityRuns& other) = delete; // copy assignment operator
+        FacilityRuns(FacilityRuns&& other) = default; // move constructor
+        FacilityRuns& operator=(FacilityRuns&& other) = delete; // move assignment opertor
+
+    private:
+        struct Run {
+            int32_t typeId; // FacilityType id, or -1 - index in patterns for a repeated period
+            uint32_t count;
+        };
+        static const uint32_t MAX_COUNT = UINT32_MAX; // a longer repetition continues in the next run
+        void appendRun(const int32_t typeId, long long count);
+        const std::deque<Run> &allRuns() const;
+        vector<vector<int>> patterns;
+        // grows by blocks, never copies all the runs at once. Created with the first run,
+        // since an empty deque already allocates and most plans never hold a run
+        std::unique_ptr<std::deque<Run>> runs;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConfigFile.h"
+using std::string;
+using std::vector;
+
+// Append-only journal of the commands that went into the actions log, one line
+// "<position> <command>" per command. Positions count the journaled commands and
+// continue the position stored in the checkpoint the session started from, so a
+// checkpoint plus the journal records after its position rebuild the state.
+//
+// Group commit: append() only copies the command into a ring buffer, without a
+// lock. A flusher thread wakes once per durability window, formats the records
+// and writes and fsyncs them, so a crash loses at most the last window of commands.
+// A window of 0 writes and fsyncs every command in append().
+class Journal {
+    public:
+        Journal();
+        bool open(const string &filePath, const int64_t position, const bool isAppending, const int windowMillis); // isAppending keeps the records up to position
+        bool isOpen() const;
+        int64_t append(const string &command); // position of the new record
+        void close(); // flushes and fsyncs what is left
+        // reads the complete records in order, stops at a torn or out of sequence line
+        static bool read(const string &filePath, const std::function<void(int64_t, const vector<ConfigToken>&, size_t)> &onRecord); // (position, command, end offset)
+        // RULE OF 5
+        ~Journal(); // destructor
+        Journal(const Journal& other) = delete; // copy constructor
+        Journal& operator=(const Journal& other) = delete; // copy assignment operator
+        Journal(Journal&& other) = delete; // move constructor
+        Journal& operator=(Journal&& other) = delete; // move assignment opertor
+
+    private:
+        static const size_t RING_SIZE = 1 << 22; // a power of two
+        void run();
+        void push(const char *bytes, size_t size); // copies into the ring, waits while it is full
+        void waitForSpace(const size_t tail);
+        bool drain(); // formats and writes what the ring holds, on the flusher or in append() without one
+        int fd;
+        int windowMillis;
+        int64_t position; // of the last appended record, moved by append() only
+        int64_t writtenPosition; // of the last record taken out of the ring
+        string positionText; // writtenPosition in decimal
+        bool isAtLineStart; // the next byte taken out of the ring starts a record
+        vector<char> ring; // "<command>\n" per record
+        std::atomic<size_t> ringHead; // bytes taken out so far, moved by drain() only
+        std::atomic<size_t> ringTail; // bytes appended so far, moved by append() only
+        string writing; // formatted by drain()
+        std::mutex lock; // only for the waits below
+        std::condition_variable wakeUp; // flusher: the ring is full or the journal closes
+        std::condition_variable spaceFreed; // append(): drain() made room in a full ring
+        std::thread flusher;
+        bool isClosing;
+        bool isFlushRequested;
+        std::atomic<bool> isFailed; // a write or fsync failed, reported once by append()
+        bool isFailureReported;
+};
+
+extern Journal journal; // opened by main with --journal
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using std::string;
+using std::vector;
+
+// Hash index from a name to the position of its first occurrence. The table is
+// split into shards with their own lock, so several threads can insert at once.
+// find() takes no lock and must not run while another thread inserts.
+class NameIndex {
+    public:
+        NameIndex();
+        void insert(const string &name, const int index); // keeps the smallest index of a name
+        int find(const string &name) const; // -1 if the name is unknown
+        void reserve(const size_t numOfNames);
+        // RULE OF 5
+        ~NameIndex(); // destructor
+        NameIndex(const NameIndex& other) = delete; // copy constructor
+        NameIndex& operator=(const NameIndex& other) = delete; // copy assignment operator
+        NameIndex(NameIndex&& other) = delete; // move constructor
+        NameIndex& operator=(NameIndex&& other) = delete; // move assignment opertor
+
+    private:
+        static const size_t NUM_OF_SHARDS = 64;
+        struct Shard {
+            Shard();
+            std::mutex lock;
+            std::unordered_map<string, int> indexes;
+        };
+        Shard &shardOf(const string &name) const;
+        vector<Shard*> shards;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+using std::vector;
+
+// Index from a NameTable id to a slot in one of Simulation's containers. Name ids
+// are dense, so the index is a plain array of slots, split into chunks that are
+// shared copy-on-write like SharedVector: copying an index for a backup is O(1)
+// and setting a slot copies at most one chunk.
+class NameSlots {
+    public:
+        NameSlots();
+        int find(const int nameId) const; // -1 if the name has no slot
+        void set(const int nameId, const int slot);
+        void clear();
+
+    private:
+        static const size_t CHUNK_SIZE = 1024;
+        typedef vector<int> Chunk;
+        typedef vector<std::shared_ptr<Chunk>> Table;
+        std::shared_ptr<Table> table;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+using std::string;
+
+// Process-wide table of interned names. A name gets a compact id the first time
+// it is seen and keeps it for the whole run; the stored strings never move, so a
+// reference returned by get() stays valid. intern(), find() and reserve() take a
+// mutex and may be called from any thread, the config loader interns from its pool
+// threads. get() takes no lock, it is safe from any thread for an id it was handed.
+class NameTable {
+    public:
+        static int intern(const string &name);
+        static int find(const string &name); // -1 if the name was never interned
+        static const string &get(const int id);
+        static void reserve(const size_t numOfNames); // room for that many more names
+};
@@ -1,6 +1,10 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include "Facility.h"
+#include "FacilityCatalogue.h"
+#include "FacilityPool.h"
+#include "FacilityRuns.h"
 #include "Settlement.h"
 #include "SelectionPolicy.h"
 #include <iostream>
@@ -14,33 +18,47 @@ enum class PlanStatus {
 
 class Plan {
     public:
-        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions);
+        Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const std::shared_ptr<const FacilityCatalogue> &facilityOptions);
         const int getlifeQualityScore() const;
         const int getEconomyScore() const;
         const int getEnvironmentScore() const;
         const string getSelectionPolicy() const;
+        const Settlement &getSettlement() const;
         void setSelectionPolicy(SelectionPolicy *selectionPolicy);
         void step();
+        void step(const int numOfSteps);
         void printStatus();
-        const vector<Facility*> &getFacilities() const;
-        void addFacility(Facility* facility);
+        void setCompact(const bool isCompact);
+        void save(CheckpointWriter &out) const; // the caller writes which settlement the plan belongs to
+        bool loadState(CheckpointReader &in, const size_t numOfOptions); // reads what save() wrote after the selection policy
         const string toString1() const;
         const string toString2() const;
         // Rule Of 5
         ~Plan(); // destructor
         Plan(const Plan& other); // copy constructor
         Plan& operator=(const Plan& other) = delete; //copy assignment operator
-        Plan(Plan&& other); // move constructor
+        Plan(Plan&& other) noexcept; // move constructor, noexcept so a vector of plans moves on growth
         Plan& operator=(const Plan&& other) = delete; // move assignment opertor
 
 
     private:
+        int stepsToNextCompletion() const;
+        void completeConstructions();
+        void addOperational(const FacilityType &type);
+        void addPeriods(const vector<int> &period, const int numOfPeriods);
+        const string cycleKey(const int policyState) const;
         int plan_id;
         const Settlement &settlement;
         SelectionPolicy *selectionPolicy; //What happens if we change this to a reference?
         PlanStatus status;
-        vector<Facility*> facilities;
-        vector<Facility*> underConstruction;
-        const vector<FacilityType> &facilityOptions;
+        bool isCompact; // operational facilities are kept as runs instead of objects
+        FacilityPool facilities; // operational facilities, shared with copies of the plan
+        FacilityRuns facilityRuns; // operational facilities in compact mode
+        bool isTracing; // record completed type ids while looking for a cycle
+        vector<int> completedTrace;
+        // facilities under construction, one column per field
+        vector<int> constructionTypes; // index in facilityOptions
+        vector<int> constructionTimes; // steps left until the facility is operational
+        const std::shared_ptr<const FacilityCatalogue> &facilityOptions; // the owner's, so it follows a replaced catalogue
         int life_quality_score, economy_score, environment_score;
 };
\ No newline at end of file
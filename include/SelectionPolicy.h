@@ -1,22 +1,44 @@
 #pragma once
 #include <vector>
 #include "Facility.h"
+#include "FacilityCatalogue.h"
 using std::vector;
 
+class CheckpointWriter;
+class CheckpointReader;
+
+// the tag written to checkpoints, also names the policy
+enum class PolicyKind {
+    NAIVE,
+    BALANCED,
+    ECONOMY,
+    SUSTAINABILITY,
+};
+
 class SelectionPolicy {
     public:
-        virtual const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) = 0;
+        virtual const FacilityType* selectFacility(const FacilityCatalogue& facilitiesOptions) = 0; // nullptr if nothing fits
         virtual const string toString() const = 0;
         virtual SelectionPolicy* clone() const = 0;
+        virtual bool getCycleState(int &state) const = 0; // false if the policy never repeats itself
+        virtual void repeatSelections(const vector<int> &typeIds, const int numOfRepeats); // account for selections skipped over by a cycle
+        virtual void save(CheckpointWriter &out) const = 0;
+        virtual PolicyKind getKind() const = 0; // also names the policy
+        static const char *kindName(const PolicyKind kind); // "nve", "bal", "eco" or "env"
+        static SelectionPolicy *load(CheckpointReader &in); // nullptr on a bad checkpoint
         virtual ~SelectionPolicy() = default;
 };
 
 class NaiveSelection: public SelectionPolicy {
     public:
         NaiveSelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        NaiveSelection(int lastSelectedIndex);
+        const FacilityType* selectFacility(const FacilityCatalogue& facilitiesOptions) override;
         const string toString() const override;
         NaiveSelection *clone() const override;
+        bool getCycleState(int &state) const override;
+        void save(CheckpointWriter &out) const override;
+        PolicyKind getKind() const override;
         ~NaiveSelection() override = default;
     private:
         int lastSelectedIndex;
@@ -25,11 +47,16 @@ class NaiveSelection: public SelectionPolicy {
 class BalancedSelection: public SelectionPolicy {
     public:
         BalancedSelection(int LifeQualityScore, int EconomyScore, int EnvironmentScore);
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType* selectFacility(const FacilityCatalogue& facilitiesOptions) override;
         const string toString() const override;
         BalancedSelection *clone() const override;
+        bool getCycleState(int &state) const override;
+        void repeatSelections(const vector<int> &typeIds, const int numOfRepeats) override;
+        void save(CheckpointWriter &out) const override;
+        PolicyKind getKind() const override;
         ~BalancedSelection() override = default;
     private:
+        static const int MAX_CYCLE_DIFFERENCE = 32767; // larger score differences don't fit in a cycle state
         int LifeQualityScore;
         int EconomyScore;
         int EnvironmentScore;
@@ -38,22 +65,32 @@ class BalancedSelection: public SelectionPolicy {
 class EconomySelection: public SelectionPolicy {
     public:
         EconomySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        EconomySelection(int lastSelectedIndex);
+        const FacilityType* selectFacility(const FacilityCatalogue& facilitiesOptions) override;
         const string toString() const override;
         EconomySelection *clone() const override;
+        bool getCycleState(int &state) const override;
+        void save(CheckpointWriter &out) const override;
+        PolicyKind getKind() const override;
         ~EconomySelection() override = default;
     private:
         int lastSelectedIndex;
+        int categoryCursor; // position of lastSelectedIndex among the ECONOMY types
 
 };
 
 class SustainabilitySelection: public SelectionPolicy {
     public:
         SustainabilitySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        SustainabilitySelection(int lastSelectedIndex);
+        const FacilityType* selectFacility(const FacilityCatalogue& facilitiesOptions) override;
         const string toString() const override;
         SustainabilitySelection *clone() const override;
+        bool getCycleState(int &state) const override;
+        void save(CheckpointWriter &out) const override;
+        PolicyKind getKind() const override;
         ~SustainabilitySelection() override = default;
     private:
         int lastSelectedIndex;
+        int categoryCursor; // position of lastSelectedIndex among the ENVIRONMENT types
 };
\ No newline at end of file
@@ -16,11 +16,12 @@ enum class SettlementType {
     public:
         Settlement(const string &name, SettlementType type);
         const string &getName() const;
+        int getNameId() const;
         SettlementType getType() const;
         const string toString() const;
 
         private:
             static string settlementTypeToString(SettlementType type);
-            const string name;
+            const int nameId; // id in NameTable
             SettlementType type;
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+using std::vector;
+
+// Copy-on-write vector of heap objects, used for the parts of Simulation that a
+// backup has to keep. Items are stored in fixed-size chunks behind shared pointers,
+// so copying a SharedVector is O(1) and both copies share every item. A write only
+// copies what is still shared on its way down: the chunk table, one chunk and the
+// item itself. Items never move once added, growing only appends chunks, so an
+// index is a stable handle (plan ids are indexes into plans).
+template <typename T>
+class SharedVector {
+    public:
+        SharedVector();
+        size_t size() const;
+        bool empty() const;
+        const T &operator[](const size_t index) const;
+        T &mutableAt(const size_t index);
+        void emplace_back(T *item); // takes ownership of item
+        template <typename... Args>
+        size_t emplace(Args&&... args); // builds the item in place, returns its index
+        void reserve(const size_t capacity);
+        void makeUnique();
+        void clear();
+
+    private:
+        static const size_t CHUNK_SIZE = 64;
+        typedef vector<std::shared_ptr<T>> Chunk;
+        typedef vector<std::shared_ptr<Chunk>> Table;
+        Table &writableTable();
+        Chunk &writableChunk(const size_t chunkIndex);
+        std::shared_ptr<T> &writableItem(const size_t index);
+        std::shared_ptr<Table> table;
+        size_t numOfItems;
+};
+
+// constructor
+template <typename T>
+SharedVector<T>::SharedVector() :
+table(std::make_shared<Table>()),
+numOfItems(0) {}
+
+template <typename T>
+size_t SharedVector<T>::size() const
+{
+    return numOfItems;
+}
+
+template <typename T>
+bool SharedVector<T>::empty() const
+{
+    return numOfItems == 0;
+}
+
+template <typename T>
+const T &SharedVector<T>::operator[](const size_t index) const
+{
+    return *(*(*table)[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+}
+
+// access for writing, unshares the item first
+template <typename T>
+T &SharedVector<T>::mutableAt(const size_t index)
+{
+    return *writableItem(index);
+}
+
+template <typename T>
+void SharedVector<T>::emplace_back(T *item)
+{
+    if (numOfItems % CHUNK_SIZE == 0)
+    {
+        writableTable().emplace_back(std::make_shared<Chunk>());
+        table->back()->reserve(CHUNK_SIZE);
+    }
+    writableChunk(numOfItems / CHUNK_SIZE).emplace_back(item);
+    numOfItems++;
+}
+
+// one allocation for the item and its reference count
+template <typename T>
+template <typename... Args>
+size_t SharedVector<T>::emplace(Args&&... args)
+{
+    if (numOfItems % CHUNK_SIZE == 0)
+    {
+        writableTable().emplace_back(std::make_shared<Chunk>());
+        table->back()->reserve(CHUNK_SIZE);
+    }
+    writableChunk(numOfItems / CHUNK_SIZE).emplace_back(std::make_shared<T>(std::forward<Args>(args)...));
+    return numOfItems++;
+}
+
+template <typename T>
+void SharedVector<T>::reserve(const size_t capacity)
+{
+    writableTable().reserve((capacity + CHUNK_SIZE - 1) / CHUNK_SIZE);
+}
+
+// unshare every item, after that mutableAt never writes to the table or the chunks
+// and can be called from several threads for different items
+template <typename T>
+void SharedVector<T>::makeUnique()
+{
+    for (size_t i = 0; i < numOfItems; i++)
+        writableItem(i);
+}
+
+template <typename T>
+void SharedVector<T>::clear()
+{
+    table = std::make_shared<Table>();
+    numOfItems = 0;
+}
+
+template <typename T>
+typename SharedVector<T>::Table &SharedVector<T>::writableTable()
+{
+    if (table.use_count() > 1)
+        table = std::make_shared<Table>(*table);
+    return *table;
+}
+
+template <typename T>
+typename SharedVector<T>::Chunk &SharedVector<T>::writableChunk(const size_t chunkIndex)
+{
+    std::shared_ptr<Chunk> &chunk = writableTable()[chunkIndex];
+    if (chunk.use_count() > 1)
+    {
+        chunk = std::make_shared<Chunk>(*chunk);
+        chunk->reserve(CHUNK_SIZE);
+    }
+    return *chunk;
+}
+
+template <typename T>
+std::shared_ptr<T> &SharedVector<T>::writableItem(const size_t index)
+{
+    std::shared_ptr<T> &item = writableChunk(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+    if (item.use_count() > 1)
+        item = std::make_shared<T>(*item);
+    return item;
+}
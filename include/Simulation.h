@@ -1,19 +1,41 @@
 #pragma once
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
+#include "ActionLog.h"
+#include "ConfigFile.h"
 #include "Facility.h"
+#include "FacilityCatalogue.h"
+#include "NameSlots.h"
 #include "Plan.h"
 #include "Settlement.h"
+#include "SharedVector.h"
+#include "ThreadPool.h"
 using std::string;
 using std::vector;
 
 class BaseAction;
 class SelectionPolicy;
 
+// why a command line produced no action
+enum class CommandError {
+    NONE,
+    UNKNOWN_COMMAND,
+    MISSING_ARGUMENT,
+    BAD_NUMBER,
+    BAD_POLICY,
+};
+
 class Simulation {
     public:
         Simulation(const string &configFilePath);
+        Simulation(const string &configFilePath, const int numOfThreads); // numOfThreads also reads the config
         void start();
+        void start(std::istream &commands, const bool isBatch);
         void addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy);
         void addAction(BaseAction *action);
         bool addSettlement(Settlement *settlement);
@@ -21,14 +43,25 @@ class Simulation {
         bool isSettlementExists(const string &settlementName);
         bool isFacilityExists(const string &facilityName);
         bool isPlanExists(const int planId);
-        Settlement &getSettlement(const string &settlementName);
+        const Settlement &getSettlement(const string &settlementName);
         Plan &getPlan(const int planID);
+        const Plan &getPlan(const int planID) const;
         const int getPlanCounter();
-        const vector<BaseAction*> &getActionsLog();
+        const ActionLog &getActionsLog();
+        int64_t getJournalPosition() const;
         void step();
+        void step(const int numOfSteps);
+        void setNumOfThreads(const int numOfThreads);
+        void setCompactMode(const bool isCompact);
         void close();
         void open();
         void restore();
+        void restore(const Simulation &snapshot);
+        bool save(const string &filePath) const;
+        bool save(const string &filePath, const std::function<void(size_t, size_t)> &onProgress) const; // (plans written, plans)
+        bool load(const string &filePath);
+        bool recover(const string &journalFilePath);
+        bool replay(const string &sessionFilePath); // headless, prints only the final report
         // RULE OF 5
         Simulation(const Simulation& other); // copy constructor
         ~Simulation(); // destructor
@@ -37,16 +70,30 @@ class Simulation {
         Simulation& operator=(Simulation&& other); // move assignment opertor
 
     private:
-        SettlementType string2settType (string input);
-        FacilityCategory string2facCategory (string input);
-        BaseAction* checkAction(vector<string> userInput);
+        SettlementType int2settType (const int input);
+        FacilityCategory int2facCategory (const int input);
+        BaseAction* checkAction(const vector<ConfigToken> &userInput, CommandError &commandError);
+        bool execute(const vector<ConfigToken> &userInput);
+        static const string commandErrorMessage(const CommandError commandError);
+        void loadConfig(const string &configFilePath);
+        ThreadPool &threadPool();
+        FacilityCatalogue &writableOptions();
         bool isRunning;
         bool isCurrActLogOrCls;
         int planCounter; //For assigning unique plan IDs
-        vector<BaseAction*> actionsLog;
-        vector<Plan> plans;
-        vector<Settlement*> settlements;
-        vector<FacilityType> facilitiesOptions;
+        int numOfThreads; // worker threads used by step()
+        ThreadPool *stepPool; // created lazily, never shared between simulations
+        bool isCompact; // plans keep operational facilities as runs
+        int64_t journalPosition; // journal records already applied to this state
+        // shared with backups and copied on write
+        ActionLog actionsLog;
+        SharedVector<Plan> plans;
+        SharedVector<Settlement> settlements;
+        std::shared_ptr<const FacilityCatalogue> facilitiesOptions; // plans refer to this pointer
+        // name -> index in settlements / facilitiesOptions, first definition wins
+        NameSlots settlementSlots;
+        NameSlots facilitySlots;
 };
 
-extern Simulation* backup;
\ No newline at end of file
+extern Simulation* backup;
+extern std::map<string, Simulation*> namedBackups; // snapshots taken with 'backup <name>'
\ No newline at end of file
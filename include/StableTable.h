@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+using std::vector;
+
+// Append-only table for the interning registries. Items live in fixed-size blocks
+// that are never moved, and the block directory never grows, so a reader can look
+// up an index it was handed while another thread appends. Appends must be
+// serialized by the caller.
+template <typename T>
+class StableTable {
+    public:
+        StableTable();
+        size_t append(const T &item); // index of the new item
+        const T &operator[](const size_t index) const;
+        T &operator[](const size_t index);
+        size_t size() const;
+        // RULE OF 5
+        ~StableTable() = default; // destructor
+        StableTable(const StableTable& other) = delete; // copy constructor
+        StableTable& operator=(const StableTable& other) = delete; // copy assignment operator
+        StableTable(StableTable&& other) = delete; // move constructor
+        StableTable& operator=(StableTable&& other) = delete; // move assignment opertor
+
+    private:
+        static const size_t BLOCK_SIZE = 4096;
+        static const size_t MAX_BLOCKS = 1 << 16;
+        std::unique_ptr<std::unique_ptr<vector<T>>[]> blocks;
+        std::atomic<size_t> numOfItems;
+};
+
+// constructor
+template <typename T>
+StableTable<T>::StableTable() :
+blocks(new std::unique_ptr<vector<T>>[MAX_BLOCKS]),
+numOfItems(0) {}
+
+template <typename T>
+size_t StableTable<T>::append(const T &item)
+{
+    size_t index = numOfItems.load();
+    if (index % BLOCK_SIZE == 0)
+    {
+        if (index / BLOCK_SIZE >= MAX_BLOCKS)
+            throw std::length_error("StableTable is full");
+        blocks[index / BLOCK_SIZE].reset(new vector<T>());
+        blocks[index / BLOCK_SIZE]->reserve(BLOCK_SIZE); // never reallocates after this
+    }
+    blocks[index / BLOCK_SIZE]->emplace_back(item);
+    numOfItems.store(index + 1);
+    return index;
+}
+
+template <typename T>
+const T &StableTable<T>::operator[](const size_t index) const
+{
+    return (*blocks[index / BLOCK_SIZE])[index % BLOCK_SIZE];
+}
+
+template <typename T>
+T &StableTable<T>::operator[](const size_t index)
+{
+    return (*blocks[index / BLOCK_SIZE])[index % BLOCK_SIZE];
+}
+
+template <typename T>
+size_t StableTable<T>::size() const
+{
+    return numOfItems.load();
+}
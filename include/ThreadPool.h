@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+using std::vector;
+
+// A fixed-size work-stealing pool. parallelFor splits [0, size) into chunks,
+// deals them round-robin to per-worker queues and blocks until all chunks ran.
+// Idle workers steal chunks from the back of the other queues.
+class ThreadPool {
+    public:
+        ThreadPool(int numOfThreads);
+        void parallelFor(size_t size, size_t chunkSize, const std::function<void(size_t, size_t)> &task);
+        int getNumOfThreads() const;
+        static int getMaxNumOfThreads(); // a few per CPU, far below what the system lets a process start
+        // RULE OF 5
+        ~ThreadPool(); // destructor
+        ThreadPool(const ThreadPool& other) = delete; // copy constructor
+        ThreadPool& operator=(const ThreadPool& other) = delete; // copy assignment operator
+        ThreadPool(ThreadPool&& other) = delete; // move constructor
+        ThreadPool& operator=(ThreadPool&& other) = delete; // move assignment opertor
+
+    private:
+        struct WorkQueue {
+            WorkQueue();
+            std::mutex lock;
+            std::deque<std::pair<size_t, size_t>> chunks;
+        };
+        void workerLoop(int workerId);
+        void runChunks(int workerId);
+        bool popChunk(int workerId, std::pair<size_t, size_t> &chunk);
+        bool stealChunk(int workerId, std::pair<size_t, size_t> &chunk);
+        const int numOfThreads;
+        vector<std::thread> workers;
+        vector<WorkQueue*> queues; // one per thread, queues[0] belongs to the caller
+        std::mutex poolLock;
+        std::condition_variable wakeUp;
+        std::condition_variable allDone;
+        const std::function<void(size_t, size_t)> *currTask;
+        std::atomic<size_t> pendingChunks;
+        size_t generation; // bumped on every parallelFor to wake the workers
+        bool isStopping;
+};
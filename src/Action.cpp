@@ -1,4 +1,6 @@
 #include "Action.h"
+#include "BackgroundSave.h"
+#include "NameTable.h"
 
 BaseAction::BaseAction() :
 errorMsg(),
@@ -13,7 +15,7 @@ void BaseAction::error(string errorMsg)
 {
     status = ActionStatus::ERROR;
     this->errorMsg = errorMsg;
-    cout << "Error: " + errorMsg << endl;
+    cout << "Error: " + errorMsg << "\n";
 }
 
 const string BaseAction::status2String() const
@@ -24,6 +26,75 @@ const string BaseAction::status2String() const
         return " COMPLETED";
 }
 
+// a record with the code and status of this action, the arguments still zero
+ActionRecord BaseAction::newRecord(const CommandCode code) const
+{
+    ActionRecord record = {static_cast<int16_t>(code), static_cast<int16_t>(status), {0, 0, 0, 0, 0, 0}};
+    return record;
+}
+
+BaseAction *BaseAction::fromRecord(const ActionRecord &record)
+{
+    const int32_t *values = record.values;
+    BaseAction *action = nullptr;
+    switch (static_cast<CommandCode>(record.code))
+    {
+        case CommandCode::STEP:
+            action = new SimulateStep(values[0]);
+            break;
+        case CommandCode::PLAN:
+            action = new AddPlan(NameTable::get(values[0]), NameTable::get(values[1]));
+            break;
+        case CommandCode::SETTLEMENT:
+            action = new AddSettlement(NameTable::get(values[0]), SettlementType(values[1]));
+            break;
+        case CommandCode::FACILITY:
+            action = new AddFacility(NameTable::get(values[0]), FacilityCategory(values[1]), values[2], values[3], values[4], values[5]);
+            break;
+        case CommandCode::PLAN_STATUS:
+            action = new PrintPlanStatus(values[0]);
+            break;
+        case CommandCode::CHANGE_POLICY:
+            action = new ChangePlanPolicy(values[0], NameTable::get(values[1]));
+            break;
+        case CommandCode::LOG:
+            action = new PrintActionsLog();
+            break;
+        case CommandCode::CLOSE:
+            action = new Close();
+            break;
+        case CommandCode::BACKUP:
+            action = new BackupSimulation(NameTable::get(values[0]));
+            break;
+        case CommandCode::RESTORE:
+            action = new RestoreSimulation(NameTable::get(values[0]));
+            break;
+        case CommandCode::BACKUPS:
+            action = new PrintBackups();
+            break;
+        case CommandCode::THREADS:
+            action = new SetNumOfThreads(values[0]);
+            break;
+        case CommandCode::SAVE:
+            action = new SaveSimulation(NameTable::get(values[0]));
+            break;
+        case CommandCode::LOAD:
+            action = new LoadSimulation(NameTable::get(values[0]));
+            break;
+        case CommandCode::BGSAVE:
+            action = new BackgroundSaveSimulation(NameTable::get(values[0]));
+            break;
+        case CommandCode::BGSTATUS:
+            action = new PrintSaveStatus();
+            break;
+        default:
+            action = new RecordedAction(NameTable::get(values[0]));
+            break;
+    }
+    action->status = static_cast<ActionStatus>(record.status);
+    return action;
+}
+
 // getters
 ActionStatus BaseAction::getStatus() const
 {
@@ -42,8 +113,7 @@ numOfSteps(numOfSteps) {}
 
 void SimulateStep::act(Simulation &simulation)
 {
-    for (int i = 0; i < numOfSteps; i++)
-        simulation.step();
+    simulation.step(numOfSteps);
     complete();
 }
 
@@ -52,6 +122,13 @@ const string SimulateStep::toString() const
     return "step " + to_string(numOfSteps) + status2String() + "\n";
 }
 
+ActionRecord SimulateStep::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::STEP);
+    record.values[0] = numOfSteps;
+    return record;
+}
+
 SimulateStep *SimulateStep::clone() const
 {
     return new SimulateStep(*this); // uses default copy consructor 
@@ -92,6 +169,14 @@ const string AddPlan::toString() const
     return "plan " + settlementName + " " + selectionPolicy + status2String() + "\n";
 }
 
+ActionRecord AddPlan::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::PLAN);
+    record.values[0] = NameTable::intern(settlementName);
+    record.values[1] = NameTable::intern(selectionPolicy);
+    return record;
+}
+
 AddPlan *AddPlan::clone() const
 {
     return new AddPlan(*this); // uses default copy consructor
@@ -131,6 +216,14 @@ const string AddSettlement::toString() const
     return str2ret + status2String() + "\n";
 }
 
+ActionRecord AddSettlement::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::SETTLEMENT);
+    record.values[0] = NameTable::intern(settlementName);
+    record.values[1] = static_cast<int32_t>(settlementType);
+    return record;
+}
+
 // .....................AddFacility.....................
 AddFacility::AddFacility(const string &facilityName, const FacilityCategory facilityCategory, const int price, const int lifeQualityScore, const int economyScore, const int environmentScore) :
 BaseAction(),
@@ -167,6 +260,18 @@ const string AddFacility::toString() const
     return str2ret;
 }
 
+ActionRecord AddFacility::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::FACILITY);
+    record.values[0] = NameTable::intern(facilityName);
+    record.values[1] = static_cast<int32_t>(facilityCategory);
+    record.values[2] = price;
+    record.values[3] = lifeQualityScore;
+    record.values[4] = economyScore;
+    record.values[5] = environmentScore;
+    return record;
+}
+
 // .....................PrintPlanStatus.....................
 PrintPlanStatus::PrintPlanStatus(int planId) :
 BaseAction(),
@@ -178,7 +283,8 @@ void PrintPlanStatus::act(Simulation &simulation)
         error("The plan doesn't exist");
     else
     {
-        cout << simulation.getPlan(planId).toString1() << endl;
+        const Simulation &view = simulation; // printing must not unshare the plan
+        cout << view.getPlan(planId).toString1() << "\n";
         complete();
     }
 }
@@ -193,6 +299,13 @@ const string PrintPlanStatus::toString() const
     return "planStatus " + to_string(planId) + (status2String()) + "\n";
 }
 
+ActionRecord PrintPlanStatus::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::PLAN_STATUS);
+    record.values[0] = planId;
+    return record;
+}
+
 // .....................ChangePlanPolicy.....................
 ChangePlanPolicy::ChangePlanPolicy(const int planId, const string &newPolicy) :
 BaseAction(),
@@ -201,13 +314,12 @@ newPolicy(newPolicy) {}
 
 void ChangePlanPolicy::act(Simulation &simulation)
 {
-    string currPolicy = simulation.getPlan(planId).getSelectionPolicy();
-    if (!simulation.isPlanExists(planId) || newPolicy == currPolicy)
-        error("Cannot change selection policy");
-    else
+    const Simulation &view = simulation;
+    string currPolicy = simulation.isPlanExists(planId) ? view.getPlan(planId).getSelectionPolicy() : "";
+    SelectionPolicy *newSelPolicy = nullptr;
+    if (simulation.isPlanExists(planId) && newPolicy != currPolicy)
     {
-        
-        SelectionPolicy *newSelPolicy = nullptr;
+        // an unknown name builds nothing and is rejected below
         if (newPolicy == "nve")
             newSelPolicy = new NaiveSelection();
         else if (newPolicy == "bal")
@@ -216,8 +328,13 @@ void ChangePlanPolicy::act(Simulation &simulation)
             newSelPolicy = new EconomySelection();
         else if (newPolicy == "env")
             newSelPolicy = new SustainabilitySelection(); 
+    }
+    if (newSelPolicy == nullptr)
+        error("Cannot change selection policy");
+    else
+    {
         simulation.getPlan(planId).setSelectionPolicy(newSelPolicy);
-        cout << "planID: " + to_string(planId) + "\npreviousPolicy: " + currPolicy + "\nnewPolicy: " + newPolicy << endl;        
+        cout << "planID: " + to_string(planId) + "\npreviousPolicy: " + currPolicy + "\nnewPolicy: " + newPolicy << "\n";        
         complete();
     }
 }
@@ -232,15 +349,24 @@ const string ChangePlanPolicy::toString() const
     return "changePolicy " + to_string(planId) + " " + newPolicy + status2String() + "\n";
 }
 
+ActionRecord ChangePlanPolicy::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::CHANGE_POLICY);
+    record.values[0] = planId;
+    record.values[1] = NameTable::intern(newPolicy);
+    return record;
+}
+
 // .....................PrintActionsLog.....................
 PrintActionsLog::PrintActionsLog() :
 BaseAction() {}
 
 void PrintActionsLog::act(Simulation &simulation)
 {
-    for (BaseAction* currAct : simulation.getActionsLog())
+    const ActionLog &actionsLog = simulation.getActionsLog();
+    for (size_t i = 0; i < actionsLog.size(); i++)
     {
-        cout << currAct->toString() << endl;
+        cout << actionsLog.toString(i) << "\n";
     }
     complete();
 }
@@ -255,14 +381,20 @@ const string PrintActionsLog::toString() const
     return "log";
 }
 
+ActionRecord PrintActionsLog::toRecord() const
+{
+    return newRecord(CommandCode::LOG);
+}
+
 // .....................Close.....................
 Close::Close() :
 BaseAction() {}
 
 void Close::act(Simulation &simulation)
 {
+    const Simulation &view = simulation; // printing must not unshare the plans
     for(int i = 0; i < simulation.getPlanCounter(); i++)
-        cout << simulation.getPlan(i).toString2() << endl;
+        cout << view.getPlan(i).toString2() << "\n";
     simulation.close();
 }
 
@@ -276,15 +408,27 @@ const string Close::toString() const
     return "The simulation has finished";
 }
 
+ActionRecord Close::toRecord() const
+{
+    return newRecord(CommandCode::CLOSE);
+}
+
 // .....................BackupSimulation.....................
 BackupSimulation::BackupSimulation() :
-BaseAction() {}
+BaseAction(),
+backupName() {}
 
+BackupSimulation::BackupSimulation(const string &backupName) :
+BaseAction(),
+backupName(backupName) {}
+
+// snapshots share everything with the simulation until one of them changes
 void BackupSimulation::act(Simulation &simulation)
 {
-    if(backup != nullptr)
-        delete backup;    
-    backup = new Simulation(simulation);
+    Simulation *&slot = backupName.empty() ? backup : namedBackups[backupName];
+    if(slot != nullptr)
+        delete slot;    
+    slot = new Simulation(simulation);
     complete();
 }
 
@@ -295,20 +439,40 @@ BackupSimulation *BackupSimulation::clone() const
 
 const string BackupSimulation::toString() const
 {
-    return "backup " + status2String() + "\n";
+    return "backup " + backupName + status2String() + "\n";
+}
+
+ActionRecord BackupSimulation::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::BACKUP);
+    record.values[0] = NameTable::intern(backupName);
+    return record;
 }
 
 // .....................RestoreSimulation.....................
 RestoreSimulation::RestoreSimulation() :
-BaseAction() {}
+BaseAction(),
+backupName() {}
+
+RestoreSimulation::RestoreSimulation(const string &backupName) :
+BaseAction(),
+backupName(backupName) {}
 
 void RestoreSimulation::act(Simulation &simulation)
 {  
-    if(backup == nullptr)
+    Simulation *snapshot = backup;
+    if (!backupName.empty())
+    {
+        map<string, Simulation*>::const_iterator found = namedBackups.find(backupName);
+        snapshot = found == namedBackups.end() ? nullptr : found->second;
+    }
+    if(snapshot == nullptr)
         error("No backup available");
     else
-        simulation.restore();
-    complete();
+    {
+        simulation.restore(*snapshot);
+        complete();
+    }
 }
 
 RestoreSimulation *RestoreSimulation::clone() const
@@ -318,5 +482,216 @@ RestoreSimulation *RestoreSimulation::clone() const
 
 const string RestoreSimulation::toString() const
 {
-    return "restore " + status2String() + "\n";
+    return "restore " + backupName + status2String() + "\n";
+}
+
+ActionRecord RestoreSimulation::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::RESTORE);
+    record.values[0] = NameTable::intern(backupName);
+    return record;
+}
+
+// .....................PrintBackups.....................
+PrintBackups::PrintBackups() :
+BaseAction() {}
+
+void PrintBackups::act(Simulation &simulation)
+{
+    if (backup != nullptr)
+        cout << "(default) plans: " + to_string(backup->getPlanCounter()) + " actions: " + to_string(backup->getActionsLog().size()) << "\n";
+    for (const pair<const string, Simulation*> &namedBackup : namedBackups)
+        cout << namedBackup.first + " plans: " + to_string(namedBackup.second->getPlanCounter()) + " actions: " + to_string(namedBackup.second->getActionsLog().size()) << "\n";
+    complete();
+}
+
+PrintBackups *PrintBackups::clone() const
+{
+    return new PrintBackups(*this); // uses default copy consructor
+}
+
+const string PrintBackups::toString() const
+{
+    return "backups" + status2String() + "\n";
+}
+
+ActionRecord PrintBackups::toRecord() const
+{
+    return newRecord(CommandCode::BACKUPS);
+}
+
+// .....................SetNumOfThreads.....................
+SetNumOfThreads::SetNumOfThreads(const int numOfThreads) :
+BaseAction(),
+numOfThreads(numOfThreads) {}
+
+void SetNumOfThreads::act(Simulation &simulation)
+{
+    if ((numOfThreads < 1) | (numOfThreads > ThreadPool::getMaxNumOfThreads()))
+        error("Number of threads must be between 1 and " + to_string(ThreadPool::getMaxNumOfThreads()));
+    else
+    {
+        simulation.setNumOfThreads(numOfThreads);
+        complete();
+    }
+}
+
+SetNumOfThreads *SetNumOfThreads::clone() const
+{
+    return new SetNumOfThreads(*this); // uses default copy consructor
+}
+
+const string SetNumOfThreads::toString() const
+{
+    return "threads " + to_string(numOfThreads) + status2String() + "\n";
+}
+
+ActionRecord SetNumOfThreads::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::THREADS);
+    record.values[0] = numOfThreads;
+    return record;
+}
+
+// .....................SaveSimulation.....................
+SaveSimulation::SaveSimulation(const string &filePath) :
+BaseAction(),
+filePath(filePath) {}
+
+void SaveSimulation::act(Simulation &simulation)
+{
+    if (!simulation.save(filePath))
+        error("Cannot save checkpoint");
+    else
+        complete();
+}
+
+SaveSimulation *SaveSimulation::clone() const
+{
+    return new SaveSimulation(*this); // uses default copy consructor
+}
+
+const string SaveSimulation::toString() const
+{
+    return "save " + filePath + status2String() + "\n";
+}
+
+ActionRecord SaveSimulation::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::SAVE);
+    record.values[0] = NameTable::intern(filePath);
+    return record;
+}
+
+// .....................LoadSimulation.....................
+LoadSimulation::LoadSimulation(const string &filePath) :
+BaseAction(),
+filePath(filePath) {}
+
+void LoadSimulation::act(Simulation &simulation)
+{
+    if (!simulation.load(filePath))
+        error("Cannot load checkpoint");
+    else
+        complete();
+}
+
+LoadSimulation *LoadSimulation::clone() const
+{
+    return new LoadSimulation(*this); // uses default copy consructor
+}
+
+const string LoadSimulation::toString() const
+{
+    return "load " + filePath + status2String() + "\n";
+}
+
+ActionRecord LoadSimulation::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::LOAD);
+    record.values[0] = NameTable::intern(filePath);
+    return record;
+}
+
+// .....................BackgroundSaveSimulation.....................
+BackgroundSaveSimulation::BackgroundSaveSimulation(const string &filePath) :
+BaseAction(),
+filePath(filePath) {}
+
+// the checkpoint is written by another thread, 'bgstatus' tells how far it got
+void BackgroundSaveSimulation::act(Simulation &simulation)
+{
+    if (!backgroundSave.start(simulation, filePath))
+        error("Background save already in progress");
+    else
+        complete();
+}
+
+BackgroundSaveSimulation *BackgroundSaveSimulation::clone() const
+{
+    return new BackgroundSaveSimulation(*this); // uses default copy consructor
+}
+
+const string BackgroundSaveSimulation::toString() const
+{
+    return "bgsave " + filePath + status2String() + "\n";
+}
+
+ActionRecord BackgroundSaveSimulation::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::BGSAVE);
+    record.values[0] = NameTable::intern(filePath);
+    return record;
+}
+
+// .....................PrintSaveStatus.....................
+PrintSaveStatus::PrintSaveStatus() :
+BaseAction() {}
+
+void PrintSaveStatus::act(Simulation &simulation)
+{
+    cout << backgroundSave.status() << "\n";
+    complete();
+}
+
+PrintSaveStatus *PrintSaveStatus::clone() const
+{
+    return new PrintSaveStatus(*this); // uses default copy consructor
+}
+
+const string PrintSaveStatus::toString() const
+{
+    return "bgstatus" + status2String() + "\n";
+}
+
+ActionRecord PrintSaveStatus::toRecord() const
+{
+    return newRecord(CommandCode::BGSTATUS);
+}
+
+// .....................RecordedAction.....................
+RecordedAction::RecordedAction(const string &text) :
+BaseAction(),
+text(text) {}
+
+void RecordedAction::act(Simulation &simulation)
+{
+    complete();
+}
+
+RecordedAction *RecordedAction::clone() const
+{
+    return new RecordedAction(*this); // uses default copy consructor
+}
+
+const string RecordedAction::toString() const
+{
+    return text;
+}
+
+ActionRecord RecordedAction::toRecord() const
+{
+    ActionRecord record = newRecord(CommandCode::RECORDED);
+    record.values[0] = NameTable::intern(text);
+    return record;
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "ActionLog.h"
+#include "Action.h"
+
+// constructor
+ActionLog::ActionLog() :
+table(std::make_shared<Table>()),
+numOfRecords(0) {}
+
+void ActionLog::append(const ActionRecord &record)
+{
+    if (table.use_count() > 1)
+        table = std::make_shared<Table>(*table);
+    if (numOfRecords % CHUNK_SIZE == 0)
+    {
+        table->emplace_back(std::make_shared<Chunk>());
+        table->back()->reserve(CHUNK_SIZE);
+    }
+    std::shared_ptr<Chunk> &chunk = table->back();
+    if (chunk.use_count() > 1)
+    {
+        // only the last chunk is ever written, copy what a backup still holds
+        chunk = std::make_shared<Chunk>(*chunk);
+        chunk->reserve(CHUNK_SIZE);
+    }
+    chunk->push_back(record);
+    numOfRecords++;
+}
+
+size_t ActionLog::size() const
+{
+    return numOfRecords;
+}
+
+const ActionRecord &ActionLog::operator[](const size_t index) const
+{
+    return (*(*table)[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+}
+
+const string ActionLog::toString(const size_t index) const
+{
+    BaseAction *action = BaseAction::fromRecord((*this)[index]);
+    string text = action->toString();
+    delete action;
+    return text;
+}
+
+void ActionLog::clear()
+{
+    table = std::make_shared<Table>();
+    numOfRecords = 0;
+}
@@ -0,0 +1,63 @@
+#include "BackgroundSave.h"
+#include "Simulation.h"
+BackgroundSave backgroundSave;
+
+// constructor
+BackgroundSave::BackgroundSave() :
+writer(),
+snapshot(nullptr),
+filePath(),
+state(BackgroundSaveState::IDLE),
+plansWritten(0),
+numOfPlans(0) {}
+
+// destructor
+BackgroundSave::~BackgroundSave()
+{
+    wait();
+}
+
+bool BackgroundSave::start(const Simulation &simulation, const string &filePath)
+{
+    if (state == BackgroundSaveState::RUNNING)
+        return false;
+    wait(); // the previous writer is done, join it and drop its snapshot
+    snapshot = new Simulation(simulation); // shares everything until the simulation changes
+    this->filePath = filePath;
+    plansWritten = 0;
+    numOfPlans = snapshot->getPlanCounter();
+    state = BackgroundSaveState::RUNNING;
+    writer = std::thread(&BackgroundSave::run, this);
+    return true;
+}
+
+// one line describing the last save
+const string BackgroundSave::status() const
+{
+    BackgroundSaveState currState = state;
+    if (currState == BackgroundSaveState::IDLE)
+        return "no background save";
+    if (currState == BackgroundSaveState::RUNNING)
+        return "saving " + filePath + " plans: " + std::to_string(plansWritten) + "/" + std::to_string(numOfPlans);
+    if (currState == BackgroundSaveState::DONE)
+        return "saved " + filePath;
+    return "failed to save " + filePath;
+}
+
+// block until the writer thread is finished
+void BackgroundSave::wait()
+{
+    if (writer.joinable())
+        writer.join();
+    delete snapshot;
+    snapshot = nullptr;
+}
+
+void BackgroundSave::run()
+{
+    bool isSaved = snapshot->save(filePath, [this](size_t written, size_t total) {
+        plansWritten = written;
+        numOfPlans = total;
+    });
+    state = isSaved ? BackgroundSaveState::DONE : BackgroundSaveState::FAILED;
+}
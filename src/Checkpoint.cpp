@@ -0,0 +1,247 @@
+#include "Checkpoint.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = {'S', 'P', 'L', 'C', 'K', 'P', 'T', '\0'};
+static const int32_t VERSION = 3; // 2: plans refer to their settlement by index, 3: journal position
+static const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(int32_t) + sizeof(int64_t);
+
+// .....................CheckpointWriter.....................
+CheckpointWriter::CheckpointWriter(const string &filePath) :
+file(filePath, std::ios::binary | std::ios::trunc),
+buffer(),
+typeIndexes(),
+typeIds(),
+written(0)
+{
+    buffer.reserve(BUFFER_SIZE);
+    putBytes(MAGIC, sizeof(MAGIC));
+    putInt(VERSION);
+    putLong(0); // offset of the type table, patched by finish()
+}
+
+bool CheckpointWriter::isOpen() const
+{
+    return file.is_open();
+}
+
+void CheckpointWriter::putInt(const int32_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putLong(const int64_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putString(const string &value)
+{
+    putInt(static_cast<int32_t>(value.size()));
+    putBytes(value.data(), value.size());
+}
+
+// write the type as an index in the type table, adding it to the table on first use
+void CheckpointWriter::putType(const FacilityType &type)
+{
+    std::unordered_map<int, int>::const_iterator found = typeIndexes.find(type.getId());
+    if (found != typeIndexes.end())
+    {
+        putInt(found->second);
+        return;
+    }
+    int index = static_cast<int>(typeIds.size());
+    typeIndexes.emplace(type.getId(), index);
+    typeIds.emplace_back(type.getId());
+    putInt(index);
+}
+
+bool CheckpointWriter::finish()
+{
+    int64_t typeTableOffset = written;
+    putInt(static_cast<int32_t>(typeIds.size()));
+    for (int typeId : typeIds)
+    {
+        const FacilityType &type = FacilityType::fromId(typeId);
+        putString(type.getName());
+        putInt(static_cast<int32_t>(type.getCategory()));
+        putInt(type.getCost());
+        putInt(type.getLifeQualityScore());
+        putInt(type.getEconomyScore());
+        putInt(type.getEnvironmentScore());
+    }
+    flush();
+    file.seekp(sizeof(MAGIC) + sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(&typeTableOffset), sizeof(typeTableOffset));
+    file.close();
+    return !file.fail();
+}
+
+void CheckpointWriter::putBytes(const void *bytes, const size_t size)
+{
+    if (buffer.size() + size > BUFFER_SIZE)
+        flush();
+    if (size > BUFFER_SIZE)
+        file.write(static_cast<const char*>(bytes), size);
+    else
+        buffer.insert(buffer.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + size);
+    written += size;
+}
+
+void CheckpointWriter::flush()
+{
+    file.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+// .....................CheckpointReader.....................
+CheckpointReader::CheckpointReader(const string &filePath) :
+data(nullptr),
+size(0),
+position(0),
+valid(false),
+typeIds()
+{
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if ((fstat(fd, &info) == 0) && (static_cast<size_t>(info.st_size) >= HEADER_SIZE))
+    {
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const char*>(mapped);
+            size = info.st_size;
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd); // the mapping stays valid
+    if (data == nullptr)
+        return;
+    valid = true;
+    char magic[sizeof(MAGIC)];
+    getBytes(magic, sizeof(magic));
+    int32_t version = getInt();
+    int64_t typeTableOffset = getLong();
+    if (!valid || (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) || (version != VERSION) || (typeTableOffset < static_cast<int64_t>(HEADER_SIZE)))
+        valid = false;
+    else
+        valid = readTypeTable(typeTableOffset);
+}
+
+// destructor
+CheckpointReader::~CheckpointReader()
+{
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+}
+
+bool CheckpointReader::isCheckpoint(const string &filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    file.read(magic, sizeof(magic));
+    return file.good() && (memcmp(magic, MAGIC, sizeof(MAGIC)) == 0);
+}
+
+bool CheckpointReader::isValid() const
+{
+    return valid;
+}
+
+int32_t CheckpointReader::getInt()
+{
+    int32_t value = 0;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+int64_t CheckpointReader::getLong()
+{
+    int64_t value = 0;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+string CheckpointReader::getString()
+{
+    int32_t length = getInt();
+    if (!valid || (length < 0) || (static_cast<size_t>(length) > size - position))
+    {
+        valid = false;
+        return "";
+    }
+    string value(data + position, length);
+    position += length;
+    return value;
+}
+
+// a corrupt count fails here instead of driving a loop far past the end of the file
+int32_t CheckpointReader::getCount(const size_t recordSize)
+{
+    int32_t count = getInt();
+    if (!valid || (count < 0) || (static_cast<size_t>(count) > getRemaining() / recordSize))
+    {
+        valid = false;
+        return 0;
+    }
+    return count;
+}
+
+int CheckpointReader::getTypeId()
+{
+    int32_t index = getInt();
+    if (!valid || (index < 0) || (static_cast<size_t>(index) >= typeIds.size()))
+    {
+        valid = false;
+        return -1;
+    }
+    return typeIds[index];
+}
+
+size_t CheckpointReader::getRemaining() const
+{
+    return size - position;
+}
+
+bool CheckpointReader::getBytes(void *bytes, const size_t size)
+{
+    if (!valid || (size > this->size - position))
+    {
+        valid = false;
+        memset(bytes, 0, size);
+        return false;
+    }
+    memcpy(bytes, data + position, size);
+    position += size;
+    return true;
+}
+
+// the type table sits at the end of the file, read it first and come back
+bool CheckpointReader::readTypeTable(const size_t offset)
+{
+    if (offset > size)
+        return false;
+    size_t bodyPosition = position;
+    position = offset;
+    int32_t numOfTypes = getCount(6 * sizeof(int32_t)); // name length, category, price and three scores
+    for (int32_t i = 0; (i < numOfTypes) & valid; i++)
+    {
+        string name = getString();
+        int32_t category = getInt();
+        int32_t price = getInt();
+        int32_t lifeQuality = getInt();
+        int32_t economy = getInt();
+        int32_t environment = getInt();
+        if ((category < static_cast<int32_t>(FacilityCategory::LIFE_QUALITY)) | (category > static_cast<int32_t>(FacilityCategory::ENVIRONMENT)))
+            valid = false;
+        if (valid)
+            typeIds.emplace_back(FacilityType(name, FacilityCategory(category), price, lifeQuality, economy, environment).getId());
+    }
+    position = bodyPosition;
+    return valid;
+}
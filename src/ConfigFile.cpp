@@ -0,0 +1,174 @@
+#include "ConfigFile.h"
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the same characters istringstream skips between words
+static bool isSpace(const char c)
+{
+    return (c == ' ') | (c == '\t') | (c == '\r') | (c == '\v') | (c == '\f');
+}
+
+// .....................ConfigToken.....................
+bool ConfigToken::equals(const char *word) const
+{
+    return (strlen(word) == length) && (memcmp(begin, word, length) == 0);
+}
+
+// leading sign and digits, the rest of the token is ignored as stoi does
+int ConfigToken::toInt() const
+{
+    int value = 0;
+    if (!toInt(value))
+    {
+        size_t i = (length > 0) && ((begin[0] == '-') | (begin[0] == '+')) ? 1 : 0;
+        if ((i < length) && (begin[i] >= '0') & (begin[i] <= '9'))
+            throw std::out_of_range("toInt");
+        throw std::invalid_argument("toInt");
+    }
+    return value;
+}
+
+bool ConfigToken::toInt(int &value) const
+{
+    size_t i = 0;
+    bool isNegative = false;
+    if ((i < length) && ((begin[i] == '-') | (begin[i] == '+')))
+        isNegative = begin[i++] == '-';
+    if ((i == length) || (begin[i] < '0') | (begin[i] > '9'))
+        return false;
+    long long result = 0;
+    for (; (i < length) && (begin[i] >= '0') & (begin[i] <= '9'); i++)
+    {
+        result = result * 10 + (begin[i] - '0');
+        if (result > static_cast<long long>(INT_MAX) + 1)
+            return false;
+    }
+    if (isNegative)
+        result = -result;
+    if (result > INT_MAX)
+        return false;
+    value = static_cast<int>(result);
+    return true;
+}
+
+const string ConfigToken::toString() const
+{
+    return string(begin, length);
+}
+
+// .....................ConfigFile.....................
+ConfigFile::ConfigFile(const string &filePath) :
+data(nullptr),
+size(0),
+position(0),
+isFileOpen(false)
+{
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+    {
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const char*>(mapped);
+            size = info.st_size;
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd); // the mapping stays valid
+    isFileOpen = true;
+}
+
+// destructor
+ConfigFile::~ConfigFile()
+{
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+}
+
+bool ConfigFile::isOpen() const
+{
+    return isFileOpen;
+}
+
+bool ConfigFile::nextLine(vector<ConfigToken> &tokens)
+{
+    return nextLine(tokens, position, size);
+}
+
+bool ConfigFile::nextLine(vector<ConfigToken> &tokens, size_t &position, const size_t end) const
+{
+    while (position < end)
+    {
+        const char *lineEnd = static_cast<const char*>(memchr(data + position, '\n', end - position));
+        if (lineEnd == nullptr)
+            lineEnd = data + end;
+        const char *curr = data + position;
+        position = lineEnd - data + 1;
+        if (*curr == '#')
+            continue; // comment
+        tokenize(curr, lineEnd, tokens);
+        if (!tokens.empty())
+            return true;
+    }
+    return false;
+}
+
+void ConfigFile::tokenize(const char *begin, const char *end, vector<ConfigToken> &tokens)
+{
+    tokens.clear();
+    const char *curr = begin;
+    while (curr < end)
+    {
+        while ((curr < end) && isSpace(*curr))
+            curr++;
+        const char *wordBegin = curr;
+        while ((curr < end) && !isSpace(*curr))
+            curr++;
+        if (curr > wordBegin)
+            tokens.push_back(ConfigToken{wordBegin, static_cast<size_t>(curr - wordBegin)});
+    }
+}
+
+// about equal ranges, every one of them starts at the beginning of a line
+vector<std::pair<size_t, size_t>> ConfigFile::split(const size_t numOfChunks) const
+{
+    vector<std::pair<size_t, size_t>> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; (i <= numOfChunks) & (begin < size); i++)
+    {
+        size_t end = size * i / numOfChunks;
+        if (end < begin)
+            end = begin;
+        const char *lineEnd = static_cast<const char*>(memchr(data + end, '\n', size - end));
+        end = (lineEnd == nullptr) | (i == numOfChunks) ? size : lineEnd - data + 1;
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    return chunks;
+}
+
+size_t ConfigFile::countLines(const char *firstWord) const
+{
+    size_t wordLength = strlen(firstWord);
+    size_t count = 0;
+    const char *curr = data;
+    const char *end = data + size;
+    while (curr < end)
+    {
+        if ((static_cast<size_t>(end - curr) > wordLength) && (memcmp(curr, firstWord, wordLength) == 0) && isSpace(curr[wordLength]))
+            count++;
+        const char *lineEnd = static_cast<const char*>(memchr(curr, '\n', end - curr));
+        if (lineEnd == nullptr)
+            break;
+        curr = lineEnd + 1;
+    }
+    return count;
+}
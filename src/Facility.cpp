@@ -1,18 +1,60 @@
 #include "Facility.h"
+#include "NameTable.h"
+#include "StableTable.h"
+#include <map>
+#include <mutex>
+#include <tuple>
+
+// flyweight table of every facility type seen so far, indexed by FacilityType::id
+static StableTable<FacilityType> &facilityTypes()
+{
+    static StableTable<FacilityType> table;
+    return table;
+}
 
 // construcrtor
 FacilityType::FacilityType(const string &name, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score) : 
-name(name),
+nameId(NameTable::intern(name)),
 category(category),
 price(price),
 lifeQuality_score(lifeQuality_score),
 economy_score(economy_score),
-environment_score(environment_score) {}
+environment_score(environment_score),
+id(-1)
+{
+    id = internType(*this);
+}
+
+// register the type once and return its id, equal types share one entry
+int FacilityType::internType(const FacilityType &type)
+{
+    static std::map<std::tuple<int, int, int, int, int, int>, int> ids;
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    std::tuple<int, int, int, int, int, int> key(type.nameId, static_cast<int>(type.category), type.price, type.lifeQuality_score, type.economy_score, type.environment_score);
+    std::map<std::tuple<int, int, int, int, int, int>, int>::const_iterator found = ids.find(key);
+    if (found != ids.end())
+        return found->second;
+    int id = static_cast<int>(facilityTypes().append(type));
+    facilityTypes()[id].id = id;
+    ids.emplace(key, id);
+    return id;
+}
+
+const FacilityType &FacilityType::fromId(const int id)
+{
+    return facilityTypes()[id];
+}
 
 // getters
 const string &FacilityType::getName() const
 {
-    return name;
+    return NameTable::get(nameId);
+}
+
+int FacilityType::getNameId() const
+{
+    return nameId;
 }
 
 int FacilityType::getCost() const
@@ -40,25 +82,71 @@ FacilityCategory FacilityType::getCategory() const
     return category;
 }
 
+int FacilityType::getId() const
+{
+    return id;
+}
+
 // .....................Facility.....................
 
 // construcrtors
 Facility::Facility(const string &name, const string &settlementName, const FacilityCategory category, const int price, const int lifeQuality_score, const int economy_score, const int environment_score) :
-FacilityType(name, category, price, lifeQuality_score, economy_score, environment_score),
-settlementName(settlementName),
+typeId(FacilityType(name, category, price, lifeQuality_score, economy_score, environment_score).getId()),
+settlementId(NameTable::intern(settlementName)),
 status(FacilityStatus::UNDER_CONSTRUCTIONS),
 timeLeft(price) {}
 
 Facility::Facility(const FacilityType &type, const string &settlementName):
-FacilityType(type),
-settlementName(settlementName),
+typeId(type.getId()),
+settlementId(NameTable::intern(settlementName)),
 status(FacilityStatus::UNDER_CONSTRUCTIONS),
 timeLeft(type.getCost()) {}
 
+Facility::Facility(const FacilityType &type, const int settlementId, const FacilityStatus status):
+typeId(type.getId()),
+settlementId(settlementId),
+status(status),
+timeLeft(status == FacilityStatus::OPERATIONAL ? 0 : type.getCost()) {}
+
 // getters
+const FacilityType &Facility::getType() const
+{
+    return FacilityType::fromId(typeId);
+}
+
+const string &Facility::getName() const
+{
+    return getType().getName();
+}
+
+int Facility::getCost() const
+{
+    return getType().getCost();
+}
+
+int Facility::getLifeQualityScore() const
+{
+    return getType().getLifeQualityScore();
+}
+
+int Facility::getEnvironmentScore() const
+{
+    return getType().getEnvironmentScore();
+}
+
+int Facility::getEconomyScore() const
+{
+    return getType().getEconomyScore();
+}
+
+FacilityCategory Facility::getCategory() const
+{
+    return getType().getCategory();
+}
+
 const string &Facility::getSettlementName() const
 {
-    return settlementName;
+    return NameTable::get(settlementId);
 }
 
 const int Facility::getTimeLeft() const
@@ -105,7 +193,7 @@ string Facility::categoryToString(FacilityCategory category)
 
 const string Facility::toString() const
 {
-    string str2ret = "FacilityName: " + name + "\nFacilityStatus: ";
+    string str2ret = "FacilityName: " + getName() + "\nFacilityStatus: ";
     if (status == FacilityStatus::UNDER_CONSTRUCTIONS)
         str2ret += "UNDER_CONSTRUCTIONS";
     else 
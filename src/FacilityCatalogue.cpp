@@ -0,0 +1,211 @@
+#include "FacilityCatalogue.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+// constructor
+FacilityCatalogue::FacilityCatalogue() :
+options(),
+categoryPositions(),
+balanceX(),
+balanceY(),
+balanceIndex(),
+balancePointIds(),
+balanceCells(),
+minCellX(0),
+maxCellX(-1),
+minCellY(0),
+maxCellY(-1) {}
+
+void FacilityCatalogue::emplace_back(const FacilityType &facility)
+{
+    int category = static_cast<int>(facility.getCategory());
+    if ((category >= 0) & (category < NUM_OF_CATEGORIES))
+        categoryPositions[category].emplace_back(static_cast<int>(options.size()));
+    int x = facility.getLifeQualityScore() - facility.getEconomyScore();
+    int y = facility.getEconomyScore() - facility.getEnvironmentScore();
+    // a type at an existing point can never be picked over the earlier one
+    if (balancePointIds.emplace(key(x, y), static_cast<int>(balanceIndex.size())).second)
+    {
+        int cellX = static_cast<int>(cellOf(x));
+        int cellY = static_cast<int>(cellOf(y));
+        balanceCells[key(cellX, cellY)].emplace_back(static_cast<int>(balanceIndex.size()));
+        balanceX.emplace_back(x);
+        balanceY.emplace_back(y);
+        balanceIndex.emplace_back(static_cast<int>(options.size()));
+        if (balanceIndex.size() == 1)
+        {
+            minCellX = maxCellX = cellX;
+            minCellY = maxCellY = cellY;
+        }
+        minCellX = std::min(minCellX, cellX);
+        maxCellX = std::max(maxCellX, cellX);
+        minCellY = std::min(minCellY, cellY);
+        maxCellY = std::max(maxCellY, cellY);
+    }
+    options.emplace_back(facility);
+}
+
+void FacilityCatalogue::reserve(const size_t capacity)
+{
+    options.reserve(capacity);
+}
+
+void FacilityCatalogue::clear()
+{
+    options.clear();
+    for (vector<int> &positions : categoryPositions)
+        positions.clear();
+    balanceX.clear();
+    balanceY.clear();
+    balanceIndex.clear();
+    balancePointIds.clear();
+    balanceCells.clear();
+    minCellX = minCellY = 0;
+    maxCellX = maxCellY = -1;
+}
+
+size_t FacilityCatalogue::size() const
+{
+    return options.size();
+}
+
+bool FacilityCatalogue::empty() const
+{
+    return options.empty();
+}
+
+const FacilityType &FacilityCatalogue::operator[](const size_t index) const
+{
+    return options[index];
+}
+
+const FacilityType *FacilityCatalogue::data() const
+{
+    return options.data();
+}
+
+vector<FacilityType>::const_iterator FacilityCatalogue::begin() const
+{
+    return options.begin();
+}
+
+vector<FacilityType>::const_iterator FacilityCatalogue::end() const
+{
+    return options.end();
+}
+
+int FacilityCatalogue::nextOfCategory(const FacilityCategory category, const int after, int &cursor) const
+{
+    int categoryIndex = static_cast<int>(category);
+    if ((categoryIndex < 0) | (categoryIndex >= NUM_OF_CATEGORIES) || categoryPositions[categoryIndex].empty())
+        return -1;
+    const vector<int> &positions = categoryPositions[categoryIndex];
+    // the cursor still points at after unless the catalogue or the policy changed under it
+    if ((cursor < 0) || (static_cast<size_t>(cursor) >= positions.size()) || (positions[cursor] != after))
+        cursor = static_cast<int>(std::upper_bound(positions.begin(), positions.end(), after) - positions.begin()) - 1;
+    cursor++;
+    if (static_cast<size_t>(cursor) >= positions.size())
+        cursor = 0; // wrap around to the first one
+    return positions[cursor];
+}
+
+long long FacilityCatalogue::key(const long long x, const long long y)
+{
+    return static_cast<long long>((static_cast<unsigned long long>(x) << 32) ^ static_cast<unsigned int>(y));
+}
+
+long long FacilityCatalogue::cellOf(const long long coordinate)
+{
+    return coordinate >= 0 ? coordinate / CELL_SIZE : -((-coordinate + CELL_SIZE - 1) / CELL_SIZE);
+}
+
+int FacilityCatalogue::mostBalanced(const int lifeQualityScore, const int economyScore, const int environmentScore) const
+{
+    if (balanceIndex.empty())
+        return -1;
+    // adding the point (x, y) leaves the differences (u, v) = (x - targetX, y - targetY)
+    // and max - min = max(|u|, |v|, |u + v|), which is at least max(|u|, |v|)
+    long long targetX = static_cast<long long>(economyScore) - lifeQualityScore;
+    long long targetY = static_cast<long long>(environmentScore) - economyScore;
+    // a few points are faster to scan than to look up cells for
+    if (balanceIndex.size() <= SCAN_POINTS)
+        return scanBalanced(targetX, targetY);
+    long long bestDistance = 0;
+    int bestIndex = -1;
+    size_t visitedCells = 0;
+    auto visit = [&](const long long cellX, const long long cellY) {
+        visitedCells++;
+        auto cell = balanceCells.find(key(cellX, cellY));
+        if (cell == balanceCells.end())
+            return;
+        for (int position : cell->second)
+        {
+            long long u = balanceX[position] - targetX;
+            long long v = balanceY[position] - targetY;
+            long long distance = std::max(std::max(std::llabs(u), std::llabs(v)), std::llabs(u + v));
+            if ((bestIndex < 0) || (distance < bestDistance) || ((distance == bestDistance) & (balanceIndex[position] < bestIndex)))
+            {
+                bestDistance = distance;
+                bestIndex = balanceIndex[position];
+            }
+        }
+    };
+    // ring r holds the cells r cells away from the target's cell, their points are at least
+    // (r - 1) * CELL_SIZE + 1 away, so the search stops once that exceeds the best distance.
+    // Rings are clipped to the occupied cells' bounding box and start at the first that meets it
+    long long centerX = cellOf(targetX);
+    long long centerY = cellOf(targetY);
+    long long firstRing = std::max(std::max(minCellX - centerX, centerX - maxCellX), std::max(minCellY - centerY, centerY - maxCellY));
+    long long lastRing = std::max(std::max(maxCellX - centerX, centerX - minCellX), std::max(maxCellY - centerY, centerY - minCellY));
+    for (long long ring = std::max(firstRing, 0LL); ring <= lastRing; ring++)
+    {
+        if ((bestIndex >= 0) && ((ring - 1) * CELL_SIZE + 1 > bestDistance))
+            break;
+        // sparse catalogue, scanning every point is cheaper than more empty cells
+        if (visitedCells > balanceCells.size())
+            return scanBalanced(targetX, targetY);
+        long long fromY = std::max(centerY - ring, static_cast<long long>(minCellY));
+        long long toY = std::min(centerY + ring, static_cast<long long>(maxCellY));
+        long long fromX = std::max(centerX - ring, static_cast<long long>(minCellX));
+        long long toX = std::min(centerX + ring, static_cast<long long>(maxCellX));
+        for (long long cellY = fromY; cellY <= toY; cellY++)
+        {
+            if ((cellY == centerY - ring) | (cellY == centerY + ring))
+            {
+                for (long long cellX = fromX; cellX <= toX; cellX++)
+                    visit(cellX, cellY);
+            }
+            else
+            {
+                if (centerX - ring >= minCellX)
+                    visit(centerX - ring, cellY);
+                if ((ring > 0) & (centerX + ring <= maxCellX))
+                    visit(centerX + ring, cellY);
+            }
+        }
+    }
+    return bestIndex;
+}
+
+// the columns are in catalogue order, so the first point at the minimum distance has the lowest index
+int FacilityCatalogue::scanBalanced(const long long targetX, const long long targetY) const
+{
+    const int *xs = balanceX.data();
+    const int *ys = balanceY.data();
+    size_t count = balanceIndex.size();
+    size_t position = 0;
+    long long minDistance = std::numeric_limits<long long>::max();
+    for (size_t i = 0; i < count; i++)
+    {
+        long long u = xs[i] - targetX;
+        long long v = ys[i] - targetY;
+        long long distance = std::max(std::max(std::llabs(u), std::llabs(v)), std::llabs(u + v));
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            position = i;
+        }
+    }
+    return balanceIndex[position];
+}
\ No newline at end of file
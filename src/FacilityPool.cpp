@@ -0,0 +1,67 @@
+#include "FacilityPool.h"
+#include <new>
+
+FacilityPool::Slab::Slab() :
+items(static_cast<Facility*>(::operator new(sizeof(Facility) * SLAB_SIZE))),
+used(0) {}
+
+FacilityPool::Slab::~Slab()
+{
+    for (size_t i = 0; i < used; i++)
+        items[i].~Facility();
+    ::operator delete(items);
+}
+
+// constructor
+FacilityPool::FacilityPool() :
+slabs() {}
+
+// copy constructor, shares the full slabs
+FacilityPool::FacilityPool(const FacilityPool &other) :
+slabs(other.slabs)
+{
+    if (!slabs.empty() && slabs.back()->used < SLAB_SIZE)
+    {
+        std::shared_ptr<Slab> last = std::make_shared<Slab>();
+        for (size_t i = 0; i < slabs.back()->used; i++)
+            new (last->items + i) Facility(slabs.back()->items[i]);
+        last->used = slabs.back()->used;
+        slabs.back() = last;
+    }
+}
+
+// move constructor
+FacilityPool::FacilityPool(FacilityPool &&other) :
+slabs(move(other.slabs))
+{
+    other.slabs.clear();
+}
+
+const Facility &FacilityPool::create(const FacilityType &type, const int settlementId, const FacilityStatus status)
+{
+    Facility *facility = new (nextSlot()) Facility(type, settlementId, status);
+    slabs.back()->used++;
+    return *facility;
+}
+
+// visit the facilities in completion order
+void FacilityPool::forEach(const std::function<void(const Facility&)> &visit) const
+{
+    for (const std::shared_ptr<Slab> &slab : slabs)
+        for (size_t i = 0; i < slab->used; i++)
+            visit(slab->items[i]);
+}
+
+// drop every facility, slabs still shared with a copy stay alive there
+void FacilityPool::clear()
+{
+    slabs.clear();
+}
+
+// raw memory for the next facility, opening a new slab when the last one is full
+void *FacilityPool::nextSlot()
+{
+    if (slabs.empty() || slabs.back()->used == SLAB_SIZE)
+        slabs.emplace_back(std::make_shared<Slab>());
+    return slabs.back()->items + slabs.back()->used;
+}
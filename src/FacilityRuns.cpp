@@ -0,0 +1,148 @@
+#include "FacilityRuns.h"
+#include "Checkpoint.h"
+#include <algorithm>
+
+// constructor
+FacilityRuns::FacilityRuns() :
+patterns(),
+runs() {}
+
+// copy constructor
+FacilityRuns::FacilityRuns(const FacilityRuns &other) :
+patterns(other.patterns),
+runs(other.runs != nullptr ? new std::deque<Run>(*other.runs) : nullptr) {}
+
+// add a single facility, extending the last run if it has the same type
+void FacilityRuns::append(const int typeId)
+{
+    appendRun(typeId, 1);
+}
+
+// add the facilities of pattern, count times in a row
+void FacilityRuns::append(const vector<int> &pattern, const long long count)
+{
+    if (pattern.empty() || count <= 0)
+        return;
+    if (pattern.size() == 1)
+        appendRun(pattern[0], count);
+    else
+    {
+        patterns.emplace_back(pattern);
+        appendRun(-static_cast<int32_t>(patterns.size()), count);
+    }
+}
+
+// extend the last run while it has the same id and room in its count
+void FacilityRuns::appendRun(const int32_t typeId, long long count)
+{
+    if ((runs == nullptr) & (count > 0))
+        runs.reset(new std::deque<Run>());
+    while (count > 0)
+    {
+        if (runs->empty() || (runs->back().typeId != typeId) || (runs->back().count == MAX_COUNT))
+            runs->push_back(Run{typeId, 0});
+        long long added = std::min<long long>(count, MAX_COUNT - runs->back().count);
+        runs->back().count += static_cast<uint32_t>(added);
+        count -= added;
+    }
+}
+
+// the runs, or no runs before the first one was added
+const std::deque<FacilityRuns::Run> &FacilityRuns::allRuns() const
+{
+    static const std::deque<Run> none;
+    return runs != nullptr ? *runs : none;
+}
+
+// expand the runs in order, calling visit with the type id of every facility
+void FacilityRuns::forEach(const std::function<void(int)> &visit) const
+{
+    for (const Run &run : allRuns())
+    {
+        if (run.typeId >= 0)
+        {
+            for (uint32_t i = 0; i < run.count; i++)
+                visit(run.typeId);
+            continue;
+        }
+        const vector<int> &pattern = patterns[-1 - run.typeId];
+        for (uint32_t i = 0; i < run.count; i++)
+            for (int typeId : pattern)
+                visit(typeId);
+    }
+}
+
+void FacilityRuns::clear()
+{
+    patterns.clear();
+    runs.reset();
+}
+
+// checkpoint
+void FacilityRuns::save(CheckpointWriter &out) const
+{
+    out.putInt(static_cast<int32_t>(allRuns().size()));
+    for (const Run &run : allRuns())
+    {
+        if (run.typeId >= 0)
+        {
+            out.putInt(1);
+            out.putLong(run.count);
+            out.putType(FacilityType::fromId(run.typeId));
+            continue;
+        }
+        const vector<int> &pattern = patterns[-1 - run.typeId];
+        out.putInt(static_cast<int32_t>(pattern.size()));
+        out.putLong(run.count);
+        for (int typeId : pattern)
+            out.putType(FacilityType::fromId(typeId));
+    }
+}
+
+// A run count is at most MAX_COUNT, save() splits longer repetitions. Every run
+// takes at least its length, its count and one type
+bool FacilityRuns::load(CheckpointReader &in)
+{
+    clear();
+    int32_t numOfRuns = in.getCount(2 * sizeof(int32_t) + sizeof(int64_t));
+    vector<int> pattern;
+    for (int32_t i = 0; (i < numOfRuns) & in.isValid(); i++)
+    {
+        int32_t length = in.getCount(sizeof(int32_t));
+        int64_t count = in.getLong();
+        if ((length == 0) | (count <= 0) | (count > MAX_COUNT))
+            return false;
+        pattern.clear();
+        for (int32_t j = 0; (j < length) & in.isValid(); j++)
+            pattern.emplace_back(in.getTypeId());
+        if (in.isValid())
+            append(pattern, count);
+    }
+    return in.isValid();
+}
+
+// the scores of all the facilities, wrapping around like the int totals of a plan
+void FacilityRuns::sumScores(int &lifeQuality, int &economy, int &environment) const
+{
+    uint32_t sums[3] = {0, 0, 0};
+    for (const Run &run : allRuns())
+    {
+        uint32_t runSums[3] = {0, 0, 0}; // of one repetition
+        auto add = [&runSums](int typeId) {
+            const FacilityType &type = FacilityType::fromId(typeId);
+            runSums[0] += static_cast<uint32_t>(type.getLifeQualityScore());
+            runSums[1] += static_cast<uint32_t>(type.getEconomyScore());
+            runSums[2] += static_cast<uint32_t>(type.getEnvironmentScore());
+        };
+        if (run.typeId >= 0)
+            add(run.typeId);
+        else
+            for (int typeId : patterns[-1 - run.typeId])
+                add(typeId);
+        for (int i = 0; i < 3; i++)
+            sums[i] += runSums[i] * run.count;
+    }
+    lifeQuality = static_cast<int>(sums[0]);
+    economy = static_cast<int>(sums[1]);
+    environment = static_cast<int>(sums[2]);
+}
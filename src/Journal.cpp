@@ -0,0 +1,251 @@
+#include "Journal.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+Journal journal;
+
+// constructor
+Journal::Journal() :
+fd(-1),
+windowMillis(0),
+position(0),
+writtenPosition(0),
+positionText(),
+isAtLineStart(true),
+ring(),
+ringHead(0),
+ringTail(0),
+writing(),
+lock(),
+wakeUp(),
+spaceFreed(),
+flusher(),
+isClosing(false),
+isFlushRequested(false),
+isFailed(false),
+isFailureReported(false) {}
+
+// destructor
+Journal::~Journal()
+{
+    close();
+}
+
+bool Journal::open(const string &filePath, const int64_t position, const bool isAppending, const int windowMillis)
+{
+    close();
+    // records after position and a torn last line are cut off, so the file continues the state
+    size_t keptSize = 0;
+    if (isAppending)
+        read(filePath, [position, &keptSize](int64_t recordPosition, const vector<ConfigToken>&, size_t endOffset) {
+            if (recordPosition == position)
+                keptSize = endOffset;
+        });
+    fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+    if ((ftruncate(fd, keptSize) != 0) || (lseek(fd, 0, SEEK_END) < 0))
+    {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    this->position = position;
+    this->windowMillis = windowMillis < 0 ? 0 : windowMillis;
+    writtenPosition = position;
+    positionText = std::to_string(position);
+    isAtLineStart = true;
+    ring.assign(RING_SIZE, '\0');
+    ringHead = 0;
+    ringTail = 0;
+    isClosing = false;
+    isFlushRequested = false;
+    isFailed = false;
+    isFailureReported = false;
+    if (this->windowMillis > 0)
+        flusher = std::thread(&Journal::run, this);
+    return true;
+}
+
+bool Journal::isOpen() const
+{
+    return fd >= 0;
+}
+
+int64_t Journal::append(const string &command)
+{
+    // only the command goes in, drain() adds the position
+    position++;
+    push(command.data(), command.size());
+    push("\n", 1);
+    if (windowMillis == 0)
+        drain();
+    if (isFailed.load(std::memory_order_relaxed) & !isFailureReported)
+    {
+        isFailureReported = true;
+        std::cout << "Error: Cannot write the journal" << "\n";
+    }
+    return position;
+}
+
+void Journal::close()
+{
+    if (fd < 0)
+        return;
+    if (flusher.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            isClosing = true;
+        }
+        wakeUp.notify_all();
+        flusher.join(); // writes what is left on its way out
+    }
+    ::close(fd);
+    fd = -1;
+}
+
+bool Journal::read(const string &filePath, const std::function<void(int64_t, const vector<ConfigToken>&, size_t)> &onRecord)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    string line;
+    vector<ConfigToken> command;
+    int64_t lastPosition = 0;
+    size_t endOffset = 0;
+    // getline only hits the end of the file on a line without its newline, a torn write
+    while (getline(file, line) && !file.eof())
+    {
+        char *rest = nullptr;
+        long long recordPosition = strtoll(line.c_str(), &rest, 10);
+        if ((rest == line.c_str()) || (*rest != ' ') || (recordPosition <= 0))
+            break;
+        if ((lastPosition > 0) & (recordPosition != lastPosition + 1))
+            break;
+        ConfigFile::tokenize(rest, line.data() + line.size(), command);
+        if (command.empty())
+            break;
+        endOffset += line.size() + 1;
+        lastPosition = recordPosition;
+        onRecord(recordPosition, command, endOffset);
+    }
+    return true;
+}
+
+// group commit: once per window, write everything appended since the last one
+void Journal::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    bool isLast = false;
+    while (!isLast)
+    {
+        wakeUp.wait_for(guard, std::chrono::milliseconds(windowMillis), [this] { return isClosing || isFlushRequested; });
+        isLast = isClosing;
+        isFlushRequested = false;
+        guard.unlock(); // append() keeps filling the ring while this batch is written
+        drain();
+        guard.lock();
+    }
+}
+
+void Journal::push(const char *bytes, size_t size)
+{
+    size_t tail = ringTail.load(std::memory_order_relaxed);
+    while (size > 0)
+    {
+        size_t free = RING_SIZE - (tail - ringHead.load(std::memory_order_acquire));
+        if (free == 0)
+        {
+            waitForSpace(tail);
+            continue;
+        }
+        size_t offset = tail & (RING_SIZE - 1);
+        size_t count = std::min(std::min(size, free), RING_SIZE - offset); // up to the end of the ring
+        memcpy(ring.data() + offset, bytes, count);
+        bytes += count;
+        size -= count;
+        tail += count;
+        ringTail.store(tail, std::memory_order_release);
+    }
+}
+
+// a full ring is written right away instead of at the end of the window
+void Journal::waitForSpace(const size_t tail)
+{
+    if (windowMillis == 0)
+    {
+        drain();
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    isFlushRequested = true;
+    wakeUp.notify_one();
+    spaceFreed.wait(guard, [this, tail] { return tail - ringHead.load(std::memory_order_acquire) < RING_SIZE; });
+}
+
+bool Journal::drain()
+{
+    size_t head = ringHead.load(std::memory_order_relaxed);
+    size_t tail = ringTail.load(std::memory_order_acquire);
+    if (head == tail)
+        return true;
+    // "<position> <command>\n" per record. A record can end up split over two
+    // batches when the command thread was copying it, the position goes before the first part
+    while (head < tail)
+    {
+        if (isAtLineStart)
+        {
+            // positions only count up by one, the decimal text is carried along
+            writtenPosition++;
+            size_t digit = positionText.size();
+            while ((digit > 0) && (positionText[digit - 1] == '9'))
+                positionText[--digit] = '0';
+            if (digit == 0)
+                positionText.insert(positionText.begin(), '1');
+            else
+                positionText[digit - 1]++;
+            writing += positionText;
+            writing += ' ';
+        }
+        size_t offset = head & (RING_SIZE - 1);
+        size_t count = std::min(tail - head, RING_SIZE - offset);
+        const char *begin = ring.data() + offset;
+        const char *lineEnd = static_cast<const char*>(memchr(begin, '\n', count));
+        if (lineEnd != nullptr)
+            count = lineEnd - begin + 1;
+        writing.append(begin, count);
+        isAtLineStart = lineEnd != nullptr;
+        head += count;
+    }
+    ringHead.store(head, std::memory_order_release);
+    if (windowMillis > 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock); // append() is either before its check or waiting
+        }
+        spaceFreed.notify_one();
+    }
+    bool isWritten = true;
+    size_t done = 0;
+    while (isWritten && (done < writing.size()))
+    {
+        ssize_t count = write(fd, writing.data() + done, writing.size() - done);
+        if ((count < 0) && (errno == EINTR))
+            continue;
+        isWritten = count > 0;
+        if (isWritten)
+            done += count;
+    }
+    isWritten = isWritten && (fdatasync(fd) == 0);
+    writing.clear();
+    if (!isWritten)
+        isFailed = true;
+    return isWritten;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "NameIndex.h"
+
+NameIndex::Shard::Shard() :
+lock(),
+indexes() {}
+
+// constructor
+NameIndex::NameIndex() :
+shards()
+{
+    for (size_t i = 0; i < NUM_OF_SHARDS; i++)
+        shards.emplace_back(new Shard());
+}
+
+// destructor
+NameIndex::~NameIndex()
+{
+    for (Shard *shard : shards)
+        delete shard;
+    shards.clear();
+}
+
+void NameIndex::insert(const string &name, const int index)
+{
+    Shard &shard = shardOf(name);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    std::pair<std::unordered_map<string, int>::iterator, bool> inserted = shard.indexes.emplace(name, index);
+    if (!inserted.second && (index < inserted.first->second))
+        inserted.first->second = index;
+}
+
+int NameIndex::find(const string &name) const
+{
+    const Shard &shard = shardOf(name);
+    std::unordered_map<string, int>::const_iterator found = shard.indexes.find(name);
+    return found == shard.indexes.end() ? -1 : found->second;
+}
+
+void NameIndex::reserve(const size_t numOfNames)
+{
+    for (Shard *shard : shards)
+        shard->indexes.reserve(numOfNames / NUM_OF_SHARDS + 1);
+}
+
+NameIndex::Shard &NameIndex::shardOf(const string &name) const
+{
+    // the low bits pick the bucket inside the shard, use the high ones here
+    return *shards[(std::hash<string>()(name) >> 24) % NUM_OF_SHARDS];
+}
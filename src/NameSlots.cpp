@@ -0,0 +1,37 @@
+#include "NameSlots.h"
+
+const size_t NameSlots::CHUNK_SIZE;
+
+// constructor
+NameSlots::NameSlots() :
+table(std::make_shared<Table>()) {}
+
+int NameSlots::find(const int nameId) const
+{
+    if (nameId < 0)
+        return -1;
+    size_t chunkIndex = static_cast<size_t>(nameId) / CHUNK_SIZE;
+    if ((chunkIndex >= table->size()) || ((*table)[chunkIndex] == nullptr))
+        return -1;
+    return (*(*table)[chunkIndex])[nameId % CHUNK_SIZE];
+}
+
+void NameSlots::set(const int nameId, const int slot)
+{
+    size_t chunkIndex = static_cast<size_t>(nameId) / CHUNK_SIZE;
+    if (table.use_count() > 1)
+        table = std::make_shared<Table>(*table);
+    if (chunkIndex >= table->size())
+        table->resize(chunkIndex + 1);
+    std::shared_ptr<Chunk> &chunk = (*table)[chunkIndex];
+    if (chunk == nullptr)
+        chunk = std::make_shared<Chunk>(CHUNK_SIZE, -1);
+    else if (chunk.use_count() > 1)
+        chunk = std::make_shared<Chunk>(*chunk);
+    (*chunk)[nameId % CHUNK_SIZE] = slot;
+}
+
+void NameSlots::clear()
+{
+    table = std::make_shared<Table>();
+}
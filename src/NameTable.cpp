@@ -0,0 +1,51 @@
+#include "NameTable.h"
+#include "StableTable.h"
+#include <mutex>
+#include <unordered_map>
+
+// storage is created on first use to avoid static initialization order issues
+static StableTable<string> &names()
+{
+    static StableTable<string> table;
+    return table;
+}
+
+static std::unordered_map<string, int> &ids()
+{
+    static std::unordered_map<string, int> index;
+    return index;
+}
+
+static std::mutex &tableLock()
+{
+    static std::mutex lock;
+    return lock;
+}
+
+int NameTable::intern(const string &name)
+{
+    std::lock_guard<std::mutex> guard(tableLock());
+    // a single hash lookup, the new id is only used when the name was missing
+    std::pair<std::unordered_map<string, int>::iterator, bool> inserted = ids().emplace(name, static_cast<int>(names().size()));
+    if (inserted.second)
+        names().append(name);
+    return inserted.first->second;
+}
+
+int NameTable::find(const string &name)
+{
+    std::lock_guard<std::mutex> guard(tableLock());
+    std::unordered_map<string, int>::const_iterator found = ids().find(name);
+    return found == ids().end() ? -1 : found->second;
+}
+
+const string &NameTable::get(const int id)
+{
+    return names()[id];
+}
+
+void NameTable::reserve(const size_t numOfNames)
+{
+    std::lock_guard<std::mutex> guard(tableLock());
+    ids().reserve(names().size() + numOfNames);
+}
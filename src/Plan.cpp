@@ -1,15 +1,24 @@
 #include "Plan.h"
+#include "Checkpoint.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
 using namespace std;
 
 // constructor
-Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions) : 
+Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const std::shared_ptr<const FacilityCatalogue> &facilityOptions) : 
 plan_id(planId),
 settlement(settlement),
-selectionPolicy(selectionPolicy),
+selectionPolicy(selectionPolicy != nullptr ? selectionPolicy : new NaiveSelection()), // a plan always has a policy
 status(PlanStatus::AVALIABLE),
+isCompact(false),
 facilities(),
-underConstruction(),
+facilityRuns(),
+isTracing(false),
+completedTrace(),
+constructionTypes(),
+constructionTimes(),
 facilityOptions(facilityOptions),
 life_quality_score(0),
 economy_score(0),
@@ -23,47 +32,39 @@ plan_id(other.plan_id),
 settlement(other.settlement),
 selectionPolicy(other.selectionPolicy->clone()),
 status(other.status),
-facilities(),
-underConstruction(),
+isCompact(other.isCompact),
+facilities(other.facilities),
+facilityRuns(other.facilityRuns),
+isTracing(false),
+completedTrace(),
+constructionTypes(other.constructionTypes),
+constructionTimes(other.constructionTimes),
 facilityOptions(other.facilityOptions),
 life_quality_score(other.life_quality_score),
 economy_score(other.economy_score),
-environment_score(other.environment_score)
-{
-    for (Facility* facility : other.facilities)
-    {
-        Facility* fac = new Facility(*facility);
-        facilities.emplace_back(fac);
-    }
-    for (Facility* facility : other.underConstruction)
-    {
-        Facility* fac = new Facility(*facility);
-        underConstruction.emplace_back(fac);
-    }    
-}
+environment_score(other.environment_score) {}
 
 // destructor
 Plan::~Plan() {
-    // Clean up facilities
-    for (Facility* facility : facilities) 
-        delete facility;
+    // Clean up facilities, the slabs go away with their last owner
     facilities.clear();
-    // Clean up underConstruction
-    for (Facility* facility : underConstruction) 
-        delete facility;
-    underConstruction.clear();
     // Clean up pointer    
     delete selectionPolicy;
 }
 
 // move constructor
-Plan::Plan(Plan &&other) :
+Plan::Plan(Plan &&other) noexcept :
 plan_id(other.plan_id),
 settlement(other.settlement),
 selectionPolicy(other.selectionPolicy),
 status(other.status),
+isCompact(other.isCompact),
 facilities(move(other.facilities)),
-underConstruction(move(other.underConstruction)),
+facilityRuns(move(other.facilityRuns)),
+isTracing(false),
+completedTrace(),
+constructionTypes(move(other.constructionTypes)),
+constructionTimes(move(other.constructionTimes)),
 facilityOptions(other.facilityOptions),
 life_quality_score(other.life_quality_score),
 economy_score(other.economy_score),
@@ -71,7 +72,8 @@ environment_score(other.environment_score)
 {
     other.selectionPolicy = nullptr;
     other.facilities.clear();
-    other.underConstruction.clear();
+    other.constructionTypes.clear();
+    other.constructionTimes.clear();
 }
 
 // getters
@@ -92,18 +94,37 @@ const int Plan::getEnvironmentScore() const
 
 const string Plan::getSelectionPolicy() const
 {
-    // get the last 3 chars of the selection policy
-    return selectionPolicy->toString().substr(selectionPolicy->toString().length() - 3);
+    return SelectionPolicy::kindName(selectionPolicy->getKind());
+}
+
+const Settlement &Plan::getSettlement() const
+{
+    return settlement;
 }
 
 // setter
 void Plan::setSelectionPolicy(SelectionPolicy *selectionPolicy)
 {
+    if (selectionPolicy == nullptr)
+        return; // keeps the current policy
     SelectionPolicy* prev = this->selectionPolicy;
     this->selectionPolicy = selectionPolicy;
     delete prev;
 }
 
+// Subtract numOfSteps from every countdown, returns how many just reached zero.
+// A plan has at most settlementType + 1 timers, too few for a vector loop to pay.
+static int countDown(vector<int> &timesLeft, int numOfSteps)
+{
+    int numOfDone = 0;
+    for (int &timeLeft : timesLeft)
+    {
+        timeLeft -= numOfSteps;
+        numOfDone += timeLeft == 0;
+    }
+    return numOfDone;
+}
+
 // step
 void Plan::step()
 { 
@@ -111,60 +132,250 @@ void Plan::step()
     if (status == PlanStatus::AVALIABLE) 
     {
         // stage 2
-        while (underConstruction.size() < static_cast<size_t>(settlement.getType()) + 1)
+        while (constructionTimes.size() < static_cast<size_t>(settlement.getType()) + 1)
         {
-            Facility *fac = new Facility(selectionPolicy->selectFacility(facilityOptions), settlement.getName());
-            addFacility (fac);
+            const FacilityType *selected = selectionPolicy->selectFacility(*facilityOptions);
+            if (selected == nullptr)
+                break; // nothing in the catalogue fits the policy, the slot stays empty
+            constructionTypes.emplace_back(static_cast<int>(selected - facilityOptions->data()));
+            constructionTimes.emplace_back(selected->getCost());
         }
     }
     // stage 3
-    for (size_t i = 0; i < underConstruction.size(); /* no increment here */)
+    if (countDown(constructionTimes, 1) > 0)
+        completeConstructions();
+    // stage 4
+    if (constructionTimes.size() == static_cast<size_t>(settlement.getType()) + 1)
+        status = PlanStatus::BUSY;
+    else 
+        status = PlanStatus::AVALIABLE;
+}
+
+// move the facilities whose countdown reached zero to the operational list, keeping the order of the others
+void Plan::completeConstructions()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < constructionTimes.size(); i++)
     {
-        // preform step and use it's returned value to decide what to do 
-        if (underConstruction[i]->step() == FacilityStatus::OPERATIONAL) 
+        if (constructionTimes[i] == 0)
+            addOperational((*facilityOptions)[constructionTypes[i]]);
+        else
         {
-            addFacility(underConstruction[i]);
-            underConstruction.erase(underConstruction.begin() + i);
-            //  Do not increment i, as the next element has shifted into the current position
+            constructionTypes[kept] = constructionTypes[i];
+            constructionTimes[kept] = constructionTimes[i];
+            kept++;
         }
-        else
+    }
+    constructionTypes.resize(kept);
+    constructionTimes.resize(kept);
+}
+
+// A plan state seen while stepping, used to find repeating patterns
+struct CycleMark {
+    int stepsLeft;
+    size_t numOfCompletions;
+};
+
+// detection only pays off on long runs, and the table of seen states is bounded
+static const int MIN_STEPS_FOR_CYCLES = 1024;
+static const size_t MAX_CYCLE_MARKS = 4096;
+
+// step numOfSteps times, jumping over the steps in which nothing completes
+void Plan::step(const int numOfSteps)
+{
+    int stepsLeft = numOfSteps;
+    int policyState = 0;
+    bool isSearchingCycle = (numOfSteps >= MIN_STEPS_FOR_CYCLES) && selectionPolicy->getCycleState(policyState);
+    unordered_map<string, CycleMark> seenStates;
+    isTracing = isSearchingCycle;
+    while (stepsLeft > 0)
+    {
+        step(); // may open construction slots and complete facilities
+        stepsLeft--;
+        // a BUSY plan only counts down until its next completion
+        if (status == PlanStatus::BUSY)
+        {
+            int idleSteps = std::min(stepsLeft, stepsToNextCompletion() - 1);
+            countDown(constructionTimes, idleSteps);
+            stepsLeft -= idleSteps;
+        }
+        if (!isSearchingCycle || stepsLeft == 0)
+            continue;
+        // the catalogue can't change during a step, so a repeated state repeats everything after it
+        if (!selectionPolicy->getCycleState(policyState))
         {
-            i++; // Increment only if no element was erased
+            isSearchingCycle = isTracing = false; // the policy left the states it can describe
+            continue;
         }
+        string key = cycleKey(policyState);
+        unordered_map<string, CycleMark>::const_iterator seen = seenStates.find(key);
+        if (seen == seenStates.end())
+        {
+            if (seenStates.size() < MAX_CYCLE_MARKS)
+                seenStates.emplace(key, CycleMark{stepsLeft, completedTrace.size()});
+            else
+                isSearchingCycle = isTracing = false;
+            continue;
+        }
+        // replay the completions of one period for every whole period that is left
+        int period = seen->second.stepsLeft - stepsLeft;
+        int numOfPeriods = stepsLeft / period;
+        vector<int> periodTypes(completedTrace.begin() + seen->second.numOfCompletions, completedTrace.end());
+        isSearchingCycle = isTracing = false;
+        addPeriods(periodTypes, numOfPeriods);
+        stepsLeft -= numOfPeriods * period;
     }
-    // stage 4
-    if (underConstruction.size() == static_cast<size_t>(settlement.getType()) + 1)
-        status = PlanStatus::BUSY;
-    else 
-        status = PlanStatus::AVALIABLE;
+    isTracing = false;
+    completedTrace.clear();
+}
+
+// append the facilities completed in one period numOfPeriods times
+void Plan::addPeriods(const vector<int> &period, const int numOfPeriods)
+{
+    // a period selects exactly the types it completes
+    selectionPolicy->repeatSelections(period, numOfPeriods);
+    if (!isCompact)
+    {
+        for (int i = 0; i < numOfPeriods; i++)
+            for (int typeId : period)
+                addOperational(FacilityType::fromId(typeId));
+        return;
+    }
+    // compact mode stores the whole repetition as one run
+    facilityRuns.append(period, numOfPeriods);
+    long long lifeQuality = 0, economy = 0, environment = 0;
+    for (int typeId : period)
+    {
+        lifeQuality += FacilityType::fromId(typeId).getLifeQualityScore();
+        economy += FacilityType::fromId(typeId).getEconomyScore();
+        environment += FacilityType::fromId(typeId).getEnvironmentScore();
+    }
+    life_quality_score += static_cast<int>(lifeQuality * numOfPeriods);
+    economy_score += static_cast<int>(economy * numOfPeriods);
+    environment_score += static_cast<int>(environment * numOfPeriods);
+}
+
+// number of steps until the first under construction facility becomes operational
+int Plan::stepsToNextCompletion() const
+{
+    int minTimeLeft = std::numeric_limits<int>::max();
+    for (int timeLeft : constructionTimes)
+        // a facility whose countdown is already below 1 never completes
+        if ((timeLeft >= 1) & (timeLeft < minTimeLeft))
+            minTimeLeft = timeLeft;
+    return minTimeLeft;
+}
+
+// everything that decides the plan's future: status, policy and the construction timers
+const string Plan::cycleKey(const int policyState) const
+{
+    string key = to_string(static_cast<int>(status)) + " " + to_string(policyState);
+    for (size_t i = 0; i < constructionTimes.size(); i++)
+        key += "|" + to_string(constructionTypes[i]) + " " + to_string(constructionTimes[i]);
+    return key;
 }
 
 // other methods
 void Plan::printStatus()
 {
-    cout << "PlanStatus: " << static_cast<int>(status) << endl;
+    cout << "PlanStatus: " << static_cast<int>(status) << "\n";
+}
+
+// switch between facility objects and runs, converting what was already built
+void Plan::setCompact(const bool isCompact)
+{
+    if (this->isCompact == isCompact)
+        return;
+    this->isCompact = isCompact;
+    if (isCompact)
+    {
+        facilities.forEach([this](const Facility &facility) {
+            facilityRuns.append(facility.getType().getId());
+        });
+        facilities.clear();
+    }
+    else
+    {
+        facilityRuns.forEach([this](int typeId) {
+            facilities.create(FacilityType::fromId(typeId), settlement.getNameId(), FacilityStatus::OPERATIONAL);
+        });
+        facilityRuns.clear();
+    }
 }
 
-const vector<Facility *> &Plan::getFacilities() const
+void Plan::addOperational(const FacilityType &type)
 {
-    return facilities;
+    if (isCompact)
+        facilityRuns.append(type.getId());
+    else
+        facilities.create(type, settlement.getNameId(), FacilityStatus::OPERATIONAL);
+    if (isTracing)
+        completedTrace.emplace_back(type.getId());
+    // update score fields
+    life_quality_score += type.getLifeQualityScore();
+    economy_score += type.getEconomyScore();
+    environment_score += type.getEnvironmentScore(); 
 }
 
-void Plan::addFacility(Facility *facility)
+// checkpoint, operational facilities are always written as runs
+void Plan::save(CheckpointWriter &out) const
 {
-    // add facility to the right vector
-    if (facility->getStatus() == FacilityStatus::UNDER_CONSTRUCTIONS) 
+    out.putInt(plan_id);
+    selectionPolicy->save(out);
+    out.putInt(static_cast<int>(status));
+    out.putInt(static_cast<int>(constructionTypes.size()));
+    for (size_t i = 0; i < constructionTypes.size(); i++)
     {
-        underConstruction.emplace_back(facility);
+        out.putInt(constructionTypes[i]);
+        out.putInt(constructionTimes[i]);
     }
-    else 
+    if (isCompact)
+    {
+        facilityRuns.save(out);
+    }
+    else
     {
-        facilities.emplace_back(facility);
-        // update score fields
-        life_quality_score += facility->getLifeQualityScore();
-        economy_score += facility->getEconomyScore();
-        environment_score += facility->getEnvironmentScore(); 
+        FacilityRuns runs;
+        facilities.forEach([&runs](const Facility &facility) {
+            runs.append(facility.getType().getId());
+        });
+        runs.save(out);
     }
+    out.putInt(life_quality_score);
+    out.putInt(economy_score);
+    out.putInt(environment_score);
+}
+
+// the plan is left in compact mode, the caller switches it with setCompact.
+// numOfOptions is the size of the catalogue the construction indices must fit.
+// The score totals are what the operational facilities add up to, so a corrupt
+// run count that no longer matches them fails here
+bool Plan::loadState(CheckpointReader &in, const size_t numOfOptions)
+{
+    facilities.clear();
+    isCompact = true;
+    int planStatus = in.getInt();
+    status = planStatus == static_cast<int>(PlanStatus::BUSY) ? PlanStatus::BUSY : PlanStatus::AVALIABLE;
+    int numOfConstructions = in.getCount(2 * sizeof(int32_t));
+    if (numOfConstructions > static_cast<int>(settlement.getType()) + 1)
+        return false;
+    for (int i = 0; (i < numOfConstructions) & in.isValid(); i++)
+    {
+        int typeIndex = in.getInt();
+        int timeLeft = in.getInt();
+        if ((typeIndex < 0) | (static_cast<size_t>(typeIndex) >= numOfOptions) | (timeLeft <= 0))
+            return false;
+        constructionTypes.emplace_back(typeIndex);
+        constructionTimes.emplace_back(timeLeft);
+    }
+    if (!facilityRuns.load(in))
+        return false;
+    life_quality_score = in.getInt();
+    economy_score = in.getInt();
+    environment_score = in.getInt();
+    int lifeQuality, economy, environment;
+    facilityRuns.sumScores(lifeQuality, economy, environment);
+    return in.isValid() & (lifeQuality == life_quality_score) & (economy == economy_score) & (environment == environment_score);
 }
 
 // toString
@@ -177,14 +388,17 @@ const string Plan::toString1() const
         str2ret +="BUSY";
     str2ret += "\n" + selectionPolicy->toString();
     str2ret += "\nLifeQualityScore: " + to_string(life_quality_score) + "\nEconomyScore: " + to_string(economy_score) + "\nEnvrionmentScore: " + to_string(environment_score) + "\n";
-    for (Facility* facility : underConstruction) 
-    {
-        str2ret += facility->toString() + "\n";
-    }
-    for (Facility* facility : facilities) 
+    for (int type : constructionTypes) 
     {
-        str2ret += facility->toString() + "\n";
+        str2ret += Facility((*facilityOptions)[type], settlement.getNameId(), FacilityStatus::UNDER_CONSTRUCTIONS).toString() + "\n";
     }
+    facilities.forEach([&str2ret](const Facility &facility) {
+        str2ret += facility.toString() + "\n";
+    });
+    // runs are expanded only for printing
+    facilityRuns.forEach([this, &str2ret](int typeId) {
+        str2ret += Facility(FacilityType::fromId(typeId), settlement.getNameId(), FacilityStatus::OPERATIONAL).toString() + "\n";
+    });
     return str2ret;
 }
 
@@ -1,22 +1,69 @@
 #include "SelectionPolicy.h"
+#include "Checkpoint.h"
 #include <cmath>
-#include <limits>
+#include <cstdlib>
+
+const char *SelectionPolicy::kindName(const PolicyKind kind)
+{
+    static const char *const names[] = {"nve", "bal", "eco", "env"};
+    return names[static_cast<int>(kind)];
+}
+
+// a policy that only keeps a position is the same after whole cycles
+void SelectionPolicy::repeatSelections(const vector<int>&, const int) {}
+
+// rebuild a policy written by save()
+SelectionPolicy *SelectionPolicy::load(CheckpointReader &in)
+{
+    SelectionPolicy *policy = nullptr;
+    int tag = in.getInt();
+    if (tag == static_cast<int>(PolicyKind::NAIVE))
+    {
+        policy = new NaiveSelection(in.getInt());
+    }
+    else if (tag == static_cast<int>(PolicyKind::BALANCED))
+    {
+        int lifeQuality = in.getInt();
+        int economy = in.getInt();
+        int environment = in.getInt();
+        policy = new BalancedSelection(lifeQuality, economy, environment);
+    }
+    else if (tag == static_cast<int>(PolicyKind::ECONOMY))
+    {
+        policy = new EconomySelection(in.getInt());
+    }
+    else if (tag == static_cast<int>(PolicyKind::SUSTAINABILITY))
+    {
+        policy = new SustainabilitySelection(in.getInt());
+    }
+    if (!in.isValid())
+    {
+        delete policy;
+        return nullptr;
+    }
+    return policy;
+}
 
 //.........................NaiveSelection.........................
 // Constructor
 NaiveSelection::NaiveSelection() : 
 lastSelectedIndex(0) {}
 
+NaiveSelection::NaiveSelection(int lastSelectedIndex) : 
+lastSelectedIndex(lastSelectedIndex) {}
+
 // selectFacility
-const FacilityType &NaiveSelection::selectFacility(const vector<FacilityType> &facilitiesOptions)
+const FacilityType *NaiveSelection::selectFacility(const FacilityCatalogue &facilitiesOptions)
 {
+    if (facilitiesOptions.empty())
+        return nullptr;
+    // wrap around once the whole list was used
+    if(static_cast<size_t>(lastSelectedIndex) >= facilitiesOptions.size())
+        lastSelectedIndex = 0;
     int currIndex = lastSelectedIndex;
     // update class field
-    if(static_cast<size_t>(lastSelectedIndex) == facilitiesOptions.size())
-        lastSelectedIndex = 0;
-    else
-        lastSelectedIndex++;
-    return facilitiesOptions[currIndex];
+    lastSelectedIndex++;
+    return &facilitiesOptions[currIndex];
 }
 
 // toString
@@ -31,6 +78,25 @@ NaiveSelection *NaiveSelection::clone() const
     return new NaiveSelection(*this); // uses default copy consructor 
 }
 
+// cycle state
+bool NaiveSelection::getCycleState(int &state) const
+{
+    state = lastSelectedIndex;
+    return true;
+}
+
+// checkpoint
+void NaiveSelection::save(CheckpointWriter &out) const
+{
+    out.putInt(static_cast<int>(PolicyKind::NAIVE));
+    out.putInt(lastSelectedIndex);
+}
+
+PolicyKind NaiveSelection::getKind() const
+{
+    return PolicyKind::NAIVE;
+}
+
 //.........................BalancedSelection.........................
 // Constructor
 BalancedSelection::BalancedSelection(int LifeQualityScore, int EconomyScore, int EnvironmentScore) :
@@ -38,41 +104,19 @@ LifeQualityScore(LifeQualityScore),
 EconomyScore(EconomyScore),
 EnvironmentScore(EnvironmentScore) {}
 
-// Calculate max and min scores
-static int MinScore(int LifeQualityScore, int EconomyScore, int EnvironmentScore)
-{
-    return std::min(std::min(LifeQualityScore, EconomyScore), EnvironmentScore);
-}
-
-static int MaxScore(int LifeQualityScore, int EconomyScore, int EnvironmentScore)
-{
-    return std::max(std::max(LifeQualityScore, EconomyScore), EnvironmentScore);
-}        
-
 // selectFacility
-const FacilityType &BalancedSelection::selectFacility(const vector<FacilityType> &facilitiesOptions)
+const FacilityType *BalancedSelection::selectFacility(const FacilityCatalogue &facilitiesOptions)
 {
-    int minDistance = std::numeric_limits<int>::max(); // MAX_INTEGER
-    int minFacIndex = 0;
-    for (size_t i = 0; i < facilitiesOptions.size(); i++)
-    {
-        // Calculate max and min scores
-        int maxScore = MaxScore(LifeQualityScore + facilitiesOptions[i].getLifeQualityScore(), EconomyScore + facilitiesOptions[i].getEconomyScore(), EnvironmentScore + facilitiesOptions[i].getEnvironmentScore());
-        int minScore = MinScore(LifeQualityScore + facilitiesOptions[i].getLifeQualityScore(), EconomyScore + facilitiesOptions[i].getEconomyScore(), EnvironmentScore + facilitiesOptions[i].getEnvironmentScore());
-        int currDistance = maxScore - minScore;
-        // Check for the current minimum distance and update the index
-        if (currDistance < minDistance)
-        {
-            minFacIndex = i;
-            minDistance = currDistance;
-        }
-    }
+    if (facilitiesOptions.empty())
+        return nullptr;
+    // the catalogue's index finds the first facility with the minimum distance
+    int minFacIndex = facilitiesOptions.mostBalanced(LifeQualityScore, EconomyScore, EnvironmentScore);
     // update class fields
     LifeQualityScore = LifeQualityScore + facilitiesOptions[minFacIndex].getLifeQualityScore();
     EconomyScore = EconomyScore + facilitiesOptions[minFacIndex].getEconomyScore();
     EnvironmentScore = EnvironmentScore + facilitiesOptions[minFacIndex].getEnvironmentScore();
     // Return the facility with the minimum distance
-    return facilitiesOptions[minFacIndex];
+    return &facilitiesOptions[minFacIndex];
 }
 
 // toString
@@ -87,25 +131,71 @@ BalancedSelection *BalancedSelection::clone() const
     return new BalancedSelection(*this); // uses default copy consructor 
 }
 
+// cycle state
+bool BalancedSelection::getCycleState(int &state) const
+{
+    // the scores keep growing, but only their differences decide the next selections
+    long long lifeQualityMinusEconomy = static_cast<long long>(LifeQualityScore) - EconomyScore;
+    long long economyMinusEnvironment = static_cast<long long>(EconomyScore) - EnvironmentScore;
+    if ((std::llabs(lifeQualityMinusEconomy) > MAX_CYCLE_DIFFERENCE) | (std::llabs(economyMinusEnvironment) > MAX_CYCLE_DIFFERENCE))
+    {
+        state = 0;
+        return false;
+    }
+    state = static_cast<int>(lifeQualityMinusEconomy * 65536 + economyMinusEnvironment);
+    return true;
+}
+
+void BalancedSelection::repeatSelections(const vector<int> &typeIds, const int numOfRepeats)
+{
+    long long lifeQuality = 0, economy = 0, environment = 0;
+    for (int typeId : typeIds)
+    {
+        lifeQuality += FacilityType::fromId(typeId).getLifeQualityScore();
+        economy += FacilityType::fromId(typeId).getEconomyScore();
+        environment += FacilityType::fromId(typeId).getEnvironmentScore();
+    }
+    LifeQualityScore += static_cast<int>(lifeQuality * numOfRepeats);
+    EconomyScore += static_cast<int>(economy * numOfRepeats);
+    EnvironmentScore += static_cast<int>(environment * numOfRepeats);
+}
+
+// checkpoint
+void BalancedSelection::save(CheckpointWriter &out) const
+{
+    out.putInt(static_cast<int>(PolicyKind::BALANCED));
+    out.putInt(LifeQualityScore);
+    out.putInt(EconomyScore);
+    out.putInt(EnvironmentScore);
+}
+
+PolicyKind BalancedSelection::getKind() const
+{
+    return PolicyKind::BALANCED;
+}
+
 //.........................EconomySelection.........................
 // Constructor
 EconomySelection::EconomySelection() :
-lastSelectedIndex(-1) {}
+lastSelectedIndex(-1),
+categoryCursor(-1) {}
+
+EconomySelection::EconomySelection(int lastSelectedIndex) :
+lastSelectedIndex(lastSelectedIndex),
+categoryCursor(-1) {}
 
 // selectFacility
-const FacilityType &EconomySelection::selectFacility(const vector<FacilityType> &facilitiesOptions)
+const FacilityType *EconomySelection::selectFacility(const FacilityCatalogue &facilitiesOptions)
 {
-    size_t i = (static_cast<size_t>(lastSelectedIndex) + 1) % facilitiesOptions.size();
-    // Search for the next ECO facility 
-    while (facilitiesOptions[i].getCategory() != FacilityCategory::ECONOMY) 
-    {
-        if (i == facilitiesOptions.size())
-            i = 0;
-        else 
-            i = (i + 1) % facilitiesOptions.size();    
-    }
+    // the next ECO facility after the last one, wrapping around
+    int after = lastSelectedIndex;
+    if ((after < -1) || (static_cast<size_t>(after) + 1 >= facilitiesOptions.size()))
+        after = facilitiesOptions.empty() ? -1 : static_cast<int>((static_cast<size_t>(after) + 1) % facilitiesOptions.size()) - 1;
+    int i = facilitiesOptions.nextOfCategory(FacilityCategory::ECONOMY, after, categoryCursor);
+    if (i < 0)
+        return nullptr; // the catalogue has no ECO facility
     lastSelectedIndex = i;
-    return facilitiesOptions[i];
+    return &facilitiesOptions[i];
 }
 
 // toString
@@ -120,25 +210,47 @@ EconomySelection *EconomySelection::clone() const
     return new EconomySelection(*this); // uses default copy consructor 
 }
 
+// cycle state
+bool EconomySelection::getCycleState(int &state) const
+{
+    state = lastSelectedIndex;
+    return true;
+}
+
+// checkpoint
+void EconomySelection::save(CheckpointWriter &out) const
+{
+    out.putInt(static_cast<int>(PolicyKind::ECONOMY));
+    out.putInt(lastSelectedIndex);
+}
+
+PolicyKind EconomySelection::getKind() const
+{
+    return PolicyKind::ECONOMY;
+}
+
 //.........................SustainabilitySelection.........................
 // Constructor
 SustainabilitySelection::SustainabilitySelection() :
-lastSelectedIndex(-1) {}
+lastSelectedIndex(-1),
+categoryCursor(-1) {}
+
+SustainabilitySelection::SustainabilitySelection(int lastSelectedIndex) :
+lastSelectedIndex(lastSelectedIndex),
+categoryCursor(-1) {}
 
 // selectFacility
-const FacilityType &SustainabilitySelection::selectFacility(const vector<FacilityType> &facilitiesOptions)
+const FacilityType *SustainabilitySelection::selectFacility(const FacilityCatalogue &facilitiesOptions)
 {
-    size_t i = (static_cast<size_t>(lastSelectedIndex) + 1) % facilitiesOptions.size();
-    // Search for the next ENV facility 
-    while (facilitiesOptions[i].getCategory() != FacilityCategory::ENVIRONMENT)
-    {
-        if (i == facilitiesOptions.size())
-            i = 0;
-        else 
-            i = (i + 1) % facilitiesOptions.size();    
-    }
+    // the next ENV facility after the last one, wrapping around
+    int after = lastSelectedIndex;
+    if ((after < -1) || (static_cast<size_t>(after) + 1 >= facilitiesOptions.size()))
+        after = facilitiesOptions.empty() ? -1 : static_cast<int>((static_cast<size_t>(after) + 1) % facilitiesOptions.size()) - 1;
+    int i = facilitiesOptions.nextOfCategory(FacilityCategory::ENVIRONMENT, after, categoryCursor);
+    if (i < 0)
+        return nullptr; // the catalogue has no ENV facility
     lastSelectedIndex = i;
-    return facilitiesOptions[i];
+    return &facilitiesOptions[i];
 }
 
 // toString
@@ -151,4 +263,23 @@ const string SustainabilitySelection::toString() const
 SustainabilitySelection *SustainabilitySelection::clone() const
 {
     return new SustainabilitySelection(*this); // uses default copy consructor 
+}
+
+// cycle state
+bool SustainabilitySelection::getCycleState(int &state) const
+{
+    state = lastSelectedIndex;
+    return true;
+}
+
+// checkpoint
+void SustainabilitySelection::save(CheckpointWriter &out) const
+{
+    out.putInt(static_cast<int>(PolicyKind::SUSTAINABILITY));
+    out.putInt(lastSelectedIndex);
+}
+
+PolicyKind SustainabilitySelection::getKind() const
+{
+    return PolicyKind::SUSTAINABILITY;
 }
\ No newline at end of file
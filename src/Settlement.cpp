@@ -1,15 +1,21 @@
 #include "Settlement.h"
+#include "NameTable.h"
 
 
 // constructor
 Settlement::Settlement(const string &name, SettlementType type) : 
-name(name),
+nameId(NameTable::intern(name)),
 type(type) {}
 
 // getters
 const string &Settlement::getName() const
 {
-    return name;
+    return NameTable::get(nameId);
+}
+
+int Settlement::getNameId() const
+{
+    return nameId;
 }
 
 SettlementType Settlement::getType() const
@@ -34,5 +40,5 @@ string Settlement::settlementTypeToString(SettlementType type)
 
 const string Settlement::toString() const
 {
-    return name + " is a " + settlementTypeToString(type);
+    return getName() + " is a " + settlementTypeToString(type);
 }
\ No newline at end of file
@@ -3,61 +3,44 @@
 #include <vector>    // For std::vector
 #include <string>    // For std::string
 #include <sstream>   // For std::istringstream
+#include <algorithm> // For std::max, std::min
+#include <cstdio>    // For std::rename
+#include <chrono>    // For std::chrono::steady_clock
+#include <climits>   // For INT_MAX
 #include "Simulation.h" 
-#include "Auxiliary.h"
 #include "Action.h"
+#include "Checkpoint.h"
+#include "ConfigFile.h"
+#include "Journal.h"
+#include "NameIndex.h"
+#include "NameTable.h"
 Simulation* backup = nullptr;
+std::map<string, Simulation*> namedBackups;
 
 // constructor
 Simulation::Simulation(const string &configFilePath) :
+Simulation(configFilePath, 1) {}
+
+Simulation::Simulation(const string &configFilePath, const int numOfThreads) :
 isRunning(false),
 isCurrActLogOrCls(false),
 planCounter(0),
+numOfThreads(std::min(std::max(numOfThreads, 1), ThreadPool::getMaxNumOfThreads())),
+stepPool(nullptr),
+isCompact(false),
+journalPosition(0),
 actionsLog(),
 plans(),
 settlements(),
-facilitiesOptions()
+facilitiesOptions(std::make_shared<FacilityCatalogue>()),
+settlementSlots(),
+facilitySlots()
 {
-    // read config file
-    ifstream configFile(configFilePath); 
-    string line;
-    while (getline(configFile, line)) 
-    {
-        if (line.empty() || line[0] == '#') 
-            continue; // Skip comments and empty lines
-        vector<string> args = Auxiliary::parseArguments(line); 
-        string command = args[0];
-        if (command == "settlement")
-            settlements.emplace_back(new Settlement(args[1], SettlementType(stoi(args[2]))));
-        else if (command == "facility")
-            facilitiesOptions.emplace_back(FacilityType(args[1], FacilityCategory(stoi(args[2])), stoi(args[3]), stoi(args[4]), stoi(args[5]), stoi(args[6])));
-        else if (command == "plan") 
-        {
-            string currSetName = args[1]; 
-            int currSet;
-            bool isFound = false;
-            for (size_t i = 0; (i < settlements.size()) & (!isFound); i++)
-            {
-                if (currSetName == settlements[i]->getName())
-                {
-                    isFound = true;
-                    currSet = i;
-                }
-            }
-            SelectionPolicy *currPolicy = nullptr;
-            if (args[2] == "nve")
-                currPolicy = new NaiveSelection();
-            else if (args[2] == "bal")
-                currPolicy = new BalancedSelection(0, 0, 0);
-            else if (args[2] == "eco")
-                currPolicy = new EconomySelection();
-            else if (args[2] == "env")
-                currPolicy = new SustainabilitySelection();
-            Plan p = Plan(planCounter, *settlements[currSet], currPolicy, facilitiesOptions);
-            plans.emplace_back(p);
-            planCounter++;  
-        }
-    }
+    // a catalogue made by --compile-config is a checkpoint and needs no parsing
+    if (!CheckpointReader::isCheckpoint(configFilePath))
+        loadConfig(configFilePath);
+    else if (!load(configFilePath))
+        cout << "Error: Cannot load checkpoint" << "\n";
 }
 
 // copy constructor
@@ -65,28 +48,23 @@ Simulation::Simulation(const Simulation &other) :
 isRunning(other.isRunning),
 isCurrActLogOrCls(other.isCurrActLogOrCls),
 planCounter(other.planCounter),
-actionsLog(),
-plans(other.plans), // no need to deep copy, Plan implements RO5
-settlements(),
-facilitiesOptions(other.facilitiesOptions)
-{
-    // deep copy actionsLog and settlements
-    for (BaseAction* action : other.actionsLog)
-        actionsLog.emplace_back(action->clone());
-    for (Settlement* settlement : other.settlements)
-        settlements.emplace_back(new Settlement(*settlement));
-}
+numOfThreads(other.numOfThreads),
+stepPool(nullptr), // the copy builds its own pool on its first step
+isCompact(other.isCompact),
+journalPosition(other.journalPosition),
+actionsLog(other.actionsLog), // shared until one side writes
+plans(other.plans),
+settlements(other.settlements),
+facilitiesOptions(other.facilitiesOptions),
+settlementSlots(other.settlementSlots),
+facilitySlots(other.facilitySlots) {}
 
 // destructor
 Simulation::~Simulation() 
 {
-    for (Settlement* settlement : settlements)
-        if (settlement != nullptr)
-            delete settlement;
-    settlements.clear(); // Clear the vector after deleting objects
-    for (BaseAction* action : actionsLog)
-        delete action;
-    actionsLog.clear();
+    // shared containers release what no other copy uses
+    delete stepPool;
+    stepPool = nullptr;
 }
 
 // copy assignment operator
@@ -95,37 +73,20 @@ Simulation& Simulation::operator =(const Simulation& other)
     // case of self-assignment
     if (this == &other)
         return *this;
-    // free resources
-    for (size_t i = 0; i < settlements.size() ; i++)
-    {
-        bool setFound = false;
-        for (size_t j = 0; (j < other.settlements.size()) & (!setFound); j++)
-            if (settlements[i]->getName() == other.settlements[j]->getName())
-                setFound = true;
-        if (!setFound)
-        {
-            delete settlements[i];
-            settlements[i] = nullptr;
-        }
-    }
-    for (BaseAction* action : actionsLog)
-        delete action;
-    actionsLog.clear();
-    plans.clear();
-    facilitiesOptions.clear();
-    // copy primitive fields
+    // copy primitive fields, keep our own pool
     isRunning = other.isRunning;
     isCurrActLogOrCls = other.isCurrActLogOrCls;
     planCounter = other.planCounter;
-    // deep copy plans
-    for (const Plan& plan : other.plans)
-        plans.emplace_back(plan); // use Plan's copy constructor
-    // deep copy facilitiesOptions
-    for (const FacilityType& facility : other.facilitiesOptions)
-        facilitiesOptions.emplace_back(FacilityType(facility.getName(), facility.getCategory(), facility.getCost(), facility.getLifeQualityScore(), facility.getEconomyScore(), facility.getEnvironmentScore()));
-    // deep copy actionsLog
-    for (const BaseAction* action : other.actionsLog)
-        actionsLog.emplace_back(action->clone());
+    numOfThreads = other.numOfThreads;
+    isCompact = other.isCompact;
+    journalPosition = other.journalPosition;
+    // share plans, settlements and actionsLog, they are copied on write
+    plans = other.plans;
+    settlements = other.settlements;
+    actionsLog = other.actionsLog;
+    facilitiesOptions = other.facilitiesOptions; // our plans follow the pointer
+    settlementSlots = other.settlementSlots;
+    facilitySlots = other.facilitySlots;
     return *this;
 }
 
@@ -134,14 +95,26 @@ Simulation::Simulation(Simulation&& other) :
 isRunning(other.isRunning),
 isCurrActLogOrCls(other.isCurrActLogOrCls),
 planCounter(other.planCounter),
+numOfThreads(other.numOfThreads),
+stepPool(other.stepPool),
+isCompact(other.isCompact),
+journalPosition(other.journalPosition),
 actionsLog(move(other.actionsLog)),
-plans(move(other.plans)), // no need to deep copy, Plan implements RO5
+plans(move(other.plans)),
 settlements(move(other.settlements)),
-facilitiesOptions(move(other.facilitiesOptions))
+facilitiesOptions(move(other.facilitiesOptions)),
+settlementSlots(move(other.settlementSlots)),
+facilitySlots(move(other.facilitySlots))
 {
     other.isRunning = false;
     other.isCurrActLogOrCls = false;
     other.planCounter = 0;
+    other.stepPool = nullptr;
+    other.actionsLog.clear();
+    other.plans.clear();
+    other.settlements.clear();
+    other.settlementSlots.clear();
+    other.facilitySlots.clear();
 }
 
 // move assignment opertor
@@ -150,127 +123,393 @@ Simulation &Simulation::operator=(Simulation &&other)
     // case of self-assignment
     if (this == & other)
         return *this;
-    // free resources
-    for (size_t i = 0; i < settlements.size() ; i++)
-    {
-        bool setFound = false;
-        for (size_t j = 0; (j < other.settlements.size()) & (!setFound); j++)
-            if (settlements[i]->getName() == other.settlements[j]->getName())
-                setFound = true;
-        if (!setFound)
-            delete settlements[i];
-    }
-    for (BaseAction* action : actionsLog)
-        delete action;
-    actionsLog.clear();
-    plans.clear();
-    facilitiesOptions.clear();
     // move fields
     isRunning = other.isRunning;
     isCurrActLogOrCls = other.isCurrActLogOrCls;
     planCounter = other.planCounter;
+    numOfThreads = other.numOfThreads;
+    delete stepPool;
+    stepPool = other.stepPool;
+    isCompact = other.isCompact;
+    journalPosition = other.journalPosition;
     plans = move(other.plans);
     facilitiesOptions = move(other.facilitiesOptions);
     actionsLog = move(other.actionsLog);
     settlements = move(other.settlements);
+    settlementSlots = move(other.settlementSlots);
+    facilitySlots = move(other.facilitySlots);
     // reset other
     other.isRunning = false;
     other.isCurrActLogOrCls = false;
     other.planCounter = 0;
+    other.stepPool = nullptr;
+    other.actionsLog.clear();
+    other.plans.clear();
+    other.settlements.clear();
+    other.settlementSlots.clear();
+    other.facilitySlots.clear();
     return *this;
 }
 
 // simulate the program
 void Simulation::start()
+{ 
+    start(std::cin, false);
+}
+
+// in batch mode there are no prompts and the end of the input closes the session quietly
+void Simulation::start(std::istream &commands, const bool isBatch)
 { 
     open();
+    string input;
+    vector<ConfigToken> userInput; // points into input, reused for every line
     while (isRunning)
     {
-        cout << "Enter command:" << endl;
-        string input;
-        getline(std::cin, input);
-        vector<string> userInput = Auxiliary::parseArguments(input);        BaseAction *currAction = checkAction(userInput);
-        currAction->act(*this);
-        if(!isCurrActLogOrCls) // don't log 'print' and 'close' actions
-            actionsLog.emplace_back(currAction);
-        else
+        if (!isBatch)
+            cout << "Enter command:" << endl;
+        if (!getline(commands, input))
         {
-            isCurrActLogOrCls = false;
-            delete currAction;
+            isRunning = false;
+            break;
         }
+        ConfigFile::tokenize(input.data(), input.data() + input.size(), userInput);
+        if (userInput.empty())
+            continue;
+        // the journal takes the same commands as the actions log
+        if (execute(userInput) && journal.isOpen())
+            journalPosition = journal.append(input);
     }
 }
 
-BaseAction* Simulation::checkAction(vector<string> userInput)
+// run one command line, true if it went into the actions log
+bool Simulation::execute(const vector<ConfigToken> &userInput)
 {
-    string firstWord = userInput[0];
-    if (firstWord == "step")
-    {
-        return new SimulateStep(stoi(userInput[1]));
-    }
-    else if (firstWord == "plan")
-    {
-        return new AddPlan(userInput[1], userInput[2]);
-    }
-    else if (firstWord == "settlement")
+    CommandError commandError = CommandError::NONE;
+    BaseAction *currAction = checkAction(userInput, commandError);
+    if (currAction == nullptr)
     {
-        SettlementType currType = string2settType(userInput[2]);
-        return new AddSettlement(userInput[1],currType); 
+        cout << "Error: " + commandErrorMessage(commandError) << "\n";
+        return false; // malformed commands are not logged
     }
-    else if (firstWord == "facility")
-    {
-        FacilityCategory currCategory = string2facCategory(userInput[2]);
-        return new AddFacility(userInput[1], currCategory, stoi(userInput[3]), stoi(userInput[4]), stoi(userInput[5]), stoi(userInput[6]));
-    }
-    else if (firstWord == "planStatus")
+    currAction->act(*this);
+    bool isLogged = !isCurrActLogOrCls; // don't log 'print' and 'close' actions
+    if (isLogged)
+        actionsLog.append(currAction->toRecord());
+    else
+        isCurrActLogOrCls = false;
+    delete currAction;
+    return isLogged;
+}
+
+// words of the commands, dispatched by length before comparing any text
+static CommandCode commandOf(const ConfigToken &word)
+{
+    switch (word.length)
     {
-        return new PrintPlanStatus(stoi(userInput[1]));
+        case 3:
+            if (word.equals("log")) return CommandCode::LOG;
+            break;
+        case 4:
+            if (word.equals("step")) return CommandCode::STEP;
+            if (word.equals("plan")) return CommandCode::PLAN;
+            if (word.equals("save")) return CommandCode::SAVE;
+            if (word.equals("load")) return CommandCode::LOAD;
+            break;
+        case 5:
+            if (word.equals("close")) return CommandCode::CLOSE;
+            break;
+        case 6:
+            if (word.equals("backup")) return CommandCode::BACKUP;
+            if (word.equals("bgsave")) return CommandCode::BGSAVE;
+            break;
+        case 7:
+            if (word.equals("restore")) return CommandCode::RESTORE;
+            if (word.equals("backups")) return CommandCode::BACKUPS;
+            if (word.equals("threads")) return CommandCode::THREADS;
+            break;
+        case 8:
+            if (word.equals("facility")) return CommandCode::FACILITY;
+            if (word.equals("bgstatus")) return CommandCode::BGSTATUS;
+            break;
+        case 10:
+            if (word.equals("settlement")) return CommandCode::SETTLEMENT;
+            if (word.equals("planStatus")) return CommandCode::PLAN_STATUS;
+            break;
+        case 12:
+            if (word.equals("changePolicy")) return CommandCode::CHANGE_POLICY;
+            break;
     }
-    else if (firstWord == "changePolicy")
+    return CommandCode::UNKNOWN;
+}
+
+// number of words a command needs, the command itself included
+static size_t minNumOfWords(const CommandCode code)
+{
+    switch (code)
     {
-        return new ChangePlanPolicy(stoi(userInput[1]), userInput[2]);
+        case CommandCode::FACILITY:
+            return 7;
+        case CommandCode::PLAN:
+        case CommandCode::SETTLEMENT:
+        case CommandCode::CHANGE_POLICY:
+            return 3;
+        case CommandCode::STEP:
+        case CommandCode::PLAN_STATUS:
+        case CommandCode::THREADS:
+        case CommandCode::SAVE:
+        case CommandCode::LOAD:
+        case CommandCode::BGSAVE:
+            return 2;
+        default:
+            return 1;
     }
-    else if (firstWord == "log")
+}
+
+// one of the names in SelectionPolicy::kindName
+static bool isPolicyName(const ConfigToken &word)
+{
+    const PolicyKind kinds[] = {PolicyKind::NAIVE, PolicyKind::BALANCED, PolicyKind::ECONOMY, PolicyKind::SUSTAINABILITY};
+    for (PolicyKind kind : kinds)
+        if (word.equals(SelectionPolicy::kindName(kind)))
+            return true;
+    return false;
+}
+
+const string Simulation::commandErrorMessage(const CommandError commandError)
+{
+    switch (commandError)
     {
-        isCurrActLogOrCls = true;
-        return new PrintActionsLog();
+        case CommandError::UNKNOWN_COMMAND:
+            return "Unknown command";
+        case CommandError::MISSING_ARGUMENT:
+            return "Missing arguments";
+        case CommandError::BAD_NUMBER:
+            return "Expected a number";
+        case CommandError::BAD_POLICY:
+            return "Unknown selection policy";
+        default:
+            return "";
     }
-    else if (firstWord == "close")
+}
+
+// build the action of a command line, or nullptr with the reason in commandError
+BaseAction* Simulation::checkAction(const vector<ConfigToken> &userInput, CommandError &commandError)
+{
+    CommandCode code = commandOf(userInput[0]);
+    commandError = CommandError::NONE;
+    if (code == CommandCode::UNKNOWN)
+        commandError = CommandError::UNKNOWN_COMMAND;
+    else if (userInput.size() < minNumOfWords(code))
+        commandError = CommandError::MISSING_ARGUMENT;
+    if (commandError != CommandError::NONE)
+        return nullptr;
+    // every number the command takes, in order
+    int numbers[5] = {0, 0, 0, 0, 0};
+    size_t firstNumber = 1, numOfNumbers = 0;
+    if ((code == CommandCode::STEP) | (code == CommandCode::PLAN_STATUS) | (code == CommandCode::CHANGE_POLICY) | (code == CommandCode::THREADS))
+        numOfNumbers = 1;
+    else if (code == CommandCode::SETTLEMENT)
+        firstNumber = 2, numOfNumbers = 1;
+    else if (code == CommandCode::FACILITY)
+        firstNumber = 2, numOfNumbers = 5;
+    for (size_t i = 0; i < numOfNumbers; i++)
+        if (!userInput[firstNumber + i].toInt(numbers[i]))
+        {
+            commandError = CommandError::BAD_NUMBER;
+            return nullptr;
+        }
+    if (((code == CommandCode::PLAN) | (code == CommandCode::CHANGE_POLICY)) && !isPolicyName(userInput[2]))
     {
-        isCurrActLogOrCls = true;
-        return new Close();
+        commandError = CommandError::BAD_POLICY;
+        return nullptr;
     }
-    else if (firstWord == "backup")
+    switch (code)
     {
-        return new BackupSimulation();
+        case CommandCode::STEP:
+            return new SimulateStep(numbers[0]);
+        case CommandCode::PLAN:
+            return new AddPlan(userInput[1].toString(), userInput[2].toString());
+        case CommandCode::SETTLEMENT:
+            return new AddSettlement(userInput[1].toString(), int2settType(numbers[0])); 
+        case CommandCode::FACILITY:
+            return new AddFacility(userInput[1].toString(), int2facCategory(numbers[0]), numbers[1], numbers[2], numbers[3], numbers[4]);
+        case CommandCode::PLAN_STATUS:
+            return new PrintPlanStatus(numbers[0]);
+        case CommandCode::CHANGE_POLICY:
+            return new ChangePlanPolicy(numbers[0], userInput[2].toString());
+        case CommandCode::LOG:
+            isCurrActLogOrCls = true;
+            return new PrintActionsLog();
+        case CommandCode::CLOSE:
+            isCurrActLogOrCls = true;
+            return new Close();
+        case CommandCode::BACKUP:
+            if (userInput.size() > 1)
+                return new BackupSimulation(userInput[1].toString());
+            return new BackupSimulation();
+        case CommandCode::RESTORE:
+            if (userInput.size() > 1)
+                return new RestoreSimulation(userInput[1].toString());
+            return new RestoreSimulation();
+        case CommandCode::BACKUPS:
+            return new PrintBackups();
+        case CommandCode::THREADS:
+            return new SetNumOfThreads(numbers[0]);
+        case CommandCode::SAVE:
+            return new SaveSimulation(userInput[1].toString());
+        case CommandCode::LOAD:
+            return new LoadSimulation(userInput[1].toString());
+        case CommandCode::BGSAVE:
+            return new BackgroundSaveSimulation(userInput[1].toString());
+        case CommandCode::BGSTATUS:
+            return new PrintSaveStatus();
+        default:
+            commandError = CommandError::UNKNOWN_COMMAND;
+            return nullptr;
     }
-    else if (firstWord == "restore")
+}
+
+// What one chunk of the config file holds, in file order within the chunk.
+struct ConfigPlanLine {
+    ConfigToken settlementName;
+    ConfigToken policy;
+    size_t numOfSettlementsBefore; // settlements defined earlier in the same chunk
+    int settlementIndex; // resolved after all chunks are read, -1 if the plan is dropped
+};
+
+struct ConfigChunk {
+    ConfigChunk() :
+    settlements(),
+    facilities(),
+    plans(),
+    firstSettlement(0) {}
+    vector<Settlement*> settlements;
+    vector<FacilityType> facilities;
+    vector<ConfigPlanLine> plans;
+    size_t firstSettlement; // index of settlements[0] in the whole file
+};
+
+// Read the config file in chunks cut at line ends. Every chunk is parsed on the pool,
+// then the chunks are merged in file order, so the result is the same as reading the
+// file line by line: a plan only sees the settlements defined above it, a repeated
+// settlement name resolves to its first definition, and plan ids follow the file.
+void Simulation::loadConfig(const string &configFilePath)
+{
+    ConfigFile configFile(configFilePath);
+    NameTable::reserve(configFile.countLines("settlement") + configFile.countLines("facility"));
+    size_t numOfChunks = numOfThreads <= 1 ? 1 : static_cast<size_t>(numOfThreads) * 4;
+    vector<std::pair<size_t, size_t>> ranges = configFile.split(numOfChunks);
+    vector<ConfigChunk> chunks(ranges.size());
+    // parse, every chunk into its own buffers
+    threadPool().parallelFor(chunks.size(), 1, [&configFile, &ranges, &chunks](size_t begin, size_t end) {
+        vector<ConfigToken> args;
+        for (size_t i = begin; i < end; i++)
+        {
+            ConfigChunk &chunk = chunks[i];
+            size_t position = ranges[i].first;
+            while (configFile.nextLine(args, position, ranges[i].second))
+            {
+                const ConfigToken &command = args[0];
+                if (command.equals("settlement") & (args.size() >= 3))
+                    chunk.settlements.emplace_back(new Settlement(args[1].toString(), SettlementType(args[2].toInt())));
+                else if (command.equals("facility") & (args.size() >= 7))
+                    chunk.facilities.emplace_back(FacilityType(args[1].toString(), FacilityCategory(args[2].toInt()), args[3].toInt(), args[4].toInt(), args[5].toInt(), args[6].toInt()));
+                else if (command.equals("plan") & (args.size() >= 3))
+                    chunk.plans.push_back(ConfigPlanLine{args[1], args[2], chunk.settlements.size(), -1});
+            }
+        }
+    });
+    // merge settlements and facilities in file order
+    size_t numOfSettlements = 0, numOfFacilities = 0, numOfPlans = 0;
+    for (ConfigChunk &chunk : chunks)
     {
-        return new RestoreSimulation();
+        chunk.firstSettlement = numOfSettlements;
+        numOfSettlements += chunk.settlements.size();
+        numOfFacilities += chunk.facilities.size();
+        numOfPlans += chunk.plans.size();
     }
-    else 
+    settlements.reserve(settlements.size() + numOfSettlements);
+    FacilityCatalogue &options = writableOptions();
+    options.reserve(options.size() + numOfFacilities);
+    plans.reserve(plans.size() + numOfPlans);
+    size_t settlementBase = settlements.size();
+    for (ConfigChunk &chunk : chunks)
     {
-        return nullptr;
+        for (Settlement *settlement : chunk.settlements)
+        {
+            if (settlementSlots.find(settlement->getNameId()) < 0)
+                settlementSlots.set(settlement->getNameId(), static_cast<int>(settlements.size()));
+            settlements.emplace_back(settlement);
+        }
+        for (const FacilityType &facility : chunk.facilities)
+        {
+            if (facilitySlots.find(facility.getNameId()) < 0)
+                facilitySlots.set(facility.getNameId(), static_cast<int>(options.size()));
+            options.emplace_back(facility);
+        }
     }
+    // index the settlement names, then resolve every plan against the index
+    NameIndex settlementIndexes;
+    settlementIndexes.reserve(settlements.size());
+    for (size_t i = 0; i < settlementBase; i++)
+        settlementIndexes.insert(settlements[i].getName(), static_cast<int>(i));
+    threadPool().parallelFor(chunks.size(), 1, [&chunks, &settlementIndexes, settlementBase](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            for (size_t j = 0; j < chunks[i].settlements.size(); j++)
+                settlementIndexes.insert(chunks[i].settlements[j]->getName(), static_cast<int>(settlementBase + chunks[i].firstSettlement + j));
+    });
+    threadPool().parallelFor(chunks.size(), 1, [&chunks, &settlementIndexes, settlementBase](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            for (ConfigPlanLine &plan : chunks[i].plans)
+            {
+                int found = settlementIndexes.find(plan.settlementName.toString());
+                // a settlement defined below the plan line is unknown to it
+                if ((found >= 0) && (static_cast<size_t>(found) < settlementBase + chunks[i].firstSettlement + plan.numOfSettlementsBefore))
+                    plan.settlementIndex = found;
+            }
+    });
+    // plan ids are handed out in file order
+    for (const ConfigChunk &chunk : chunks)
+        for (const ConfigPlanLine &plan : chunk.plans)
+        {
+            SelectionPolicy *currPolicy = nullptr;
+            if (plan.policy.equals("nve"))
+                currPolicy = new NaiveSelection();
+            else if (plan.policy.equals("bal"))
+                currPolicy = new BalancedSelection(0, 0, 0);
+            else if (plan.policy.equals("eco"))
+                currPolicy = new EconomySelection();
+            else if (plan.policy.equals("env"))
+                currPolicy = new SustainabilitySelection();
+            if ((plan.settlementIndex < 0) | (currPolicy == nullptr))
+            {
+                delete currPolicy;
+                continue; // unknown settlement or policy
+            }
+            plans.emplace(planCounter, settlements[plan.settlementIndex], currPolicy, facilitiesOptions);
+            planCounter++;
+        }
 }
 
 // adders
 void Simulation::addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy)
 {
-    Plan p = Plan(planCounter, settlement, selectionPolicy, facilitiesOptions);
-    plans.emplace_back(p);
+    size_t index = plans.emplace(planCounter, settlement, selectionPolicy, facilitiesOptions);
+    plans.mutableAt(index).setCompact(isCompact);
     planCounter++;
 }
 
 void Simulation::addAction(BaseAction *action)
 {
-    actionsLog.emplace_back(action);
+    actionsLog.append(action->toRecord());
+    delete action;
 }
 
 bool Simulation::addSettlement(Settlement *settlement)
 {
     if (!isSettlementExists(settlement->getName()))
     {
+        settlementSlots.set(settlement->getNameId(), static_cast<int>(settlements.size()));
         settlements.emplace_back(settlement);
         return true;        
     }
@@ -282,7 +521,9 @@ bool Simulation::addFacility(FacilityType facility)
 {
     if (!isFacilityExists(facility.getName()))
     {
-        facilitiesOptions.emplace_back(facility);
+        FacilityCatalogue &options = writableOptions();
+        facilitySlots.set(facility.getNameId(), static_cast<int>(options.size()));
+        options.emplace_back(facility);
         return true;
     }
     else
@@ -290,21 +531,21 @@ bool Simulation::addFacility(FacilityType facility)
 }
 
 // auxiliary functions
-SettlementType Simulation::string2settType (string input)
+SettlementType Simulation::int2settType (const int input)
 {
-    if (stoi(input) == 0)
+    if (input == 0)
         return SettlementType::VILLAGE;
-    else if (stoi(input) == 1)
+    else if (input == 1)
         return SettlementType::CITY;
     else
         return SettlementType::METROPOLIS;
 }
 
-FacilityCategory Simulation::string2facCategory (string input)
+FacilityCategory Simulation::int2facCategory (const int input)
 {
-    if (stoi(input) == 0)
+    if (input == 0)
         return FacilityCategory::LIFE_QUALITY;
-    else if (stoi(input) == 1)
+    else if (input == 1)
         return FacilityCategory::ECONOMY;
     else
         return FacilityCategory::ENVIRONMENT;
@@ -312,20 +553,12 @@ FacilityCategory Simulation::string2facCategory (string input)
 
 bool Simulation::isSettlementExists(const string &settlementName)
 {
-    bool isExist = false; 
-    for (size_t i = 0; (i < settlements.size()) & (!isExist); i++)
-        if (settlementName == settlements[i]->getName())
-            isExist = true;
-    return isExist;
+    return settlementSlots.find(NameTable::find(settlementName)) >= 0;
 }
 
 bool Simulation::isFacilityExists(const string &facilityName)
 {
-    bool isExist = false; 
-        for (size_t i = 0; (i < facilitiesOptions.size()) & (!isExist); i++)
-            if (facilityName == facilitiesOptions[i].getName())
-                isExist = true;
-    return isExist;
+    return facilitySlots.find(NameTable::find(facilityName)) >= 0;
 }
 
 bool Simulation::isPlanExists(const int planId)
@@ -337,16 +570,21 @@ bool Simulation::isPlanExists(const int planId)
 }
 
 // getters
-Settlement &Simulation::getSettlement(const string &settlementName)
+const Settlement &Simulation::getSettlement(const string &settlementName)
 {
-    for (Settlement *settlement : settlements)
-        if (settlementName == settlement->getName())
-            return *settlement;
+    int slot = settlementSlots.find(NameTable::find(settlementName));
+    if (slot >= 0)
+        return settlements[slot];
     static Settlement defualtSet("noSet", SettlementType::VILLAGE);
     return defualtSet;
 }
 
 Plan &Simulation::getPlan(const int planID)
+{
+    return plans.mutableAt(planID); // a plan shared with a backup is copied here
+}
+
+const Plan &Simulation::getPlan(const int planID) const
 {
     return plans[planID];
 }
@@ -356,31 +594,316 @@ const int Simulation::getPlanCounter()
     return planCounter;
 }
 
-const vector<BaseAction *> &Simulation::getActionsLog()
+const ActionLog &Simulation::getActionsLog()
 {
     return actionsLog;
 }
 
+int64_t Simulation::getJournalPosition() const
+{
+    return journalPosition;
+}
+
+// setters
+void Simulation::setNumOfThreads(const int numOfThreads)
+{
+    this->numOfThreads = numOfThreads;
+}
+
+void Simulation::setCompactMode(const bool isCompact)
+{
+    this->isCompact = isCompact;
+    for (size_t i = 0; i < plans.size(); i++)
+        plans.mutableAt(i).setCompact(isCompact);
+}
+
 // step
 void Simulation::step()
 {
-    for (Plan &plan : plans)
-        plan.step();
+    step(1);
+}
+
+void Simulation::step(const int numOfSteps)
+{
+    // unshare every plan first, the workers then only touch their own plans
+    plans.makeUnique();
+    if (numOfThreads <= 1)
+    {
+        for (size_t i = 0; i < plans.size(); i++)
+            plans.mutableAt(i).step(numOfSteps);
+        return;
+    }
+    // plans never touch each other's state, so any split gives the serial result
+    size_t chunkSize = std::max(static_cast<size_t>(16), plans.size() / (static_cast<size_t>(numOfThreads) * 8));
+    threadPool().parallelFor(plans.size(), chunkSize, [this, numOfSteps](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            plans.mutableAt(i).step(numOfSteps);
+    });
+}
+
+// the pool follows numOfThreads, it is rebuilt when the count changed
+ThreadPool &Simulation::threadPool()
+{
+    if (stepPool == nullptr || stepPool->getNumOfThreads() != numOfThreads)
+    {
+        delete stepPool;
+        stepPool = new ThreadPool(numOfThreads);
+    }
+    return *stepPool;
+}
+
+// the catalogue is shared with backups and snapshots, copy it before the first change
+FacilityCatalogue &Simulation::writableOptions()
+{
+    if (facilitiesOptions.use_count() > 1)
+        facilitiesOptions = std::make_shared<FacilityCatalogue>(*facilitiesOptions);
+    // every catalogue is made as a FacilityCatalogue, only its holders see it as const
+    return const_cast<FacilityCatalogue &>(*facilitiesOptions);
 }
 
 void Simulation::close()
 {
     isRunning = false;
-    cout << "The simulation has ended." << endl;
+    cout << "The simulation has ended." << "\n";
 }
 
 void Simulation::open()
 {
-    cout << "The simulation has started" << endl;
+    cout << "The simulation has started" << "\n";
     isRunning = true;
 }
 
 void Simulation::restore()
 {
-    *this = *backup; // copy assignment operator of Simulation
+    restore(*backup);
+}
+
+void Simulation::restore(const Simulation &snapshot)
+{
+    *this = snapshot; // copy assignment operator of Simulation, shares the snapshot's state
+}
+
+bool Simulation::save(const string &filePath) const
+{
+    return save(filePath, [](size_t, size_t) {});
+}
+
+// write a binary checkpoint, next to the target first so a failed save keeps the old file
+bool Simulation::save(const string &filePath, const std::function<void(size_t, size_t)> &onProgress) const
+{
+    string tempPath = filePath + ".tmp";
+    CheckpointWriter out(tempPath);
+    if (!out.isOpen())
+        return false;
+    out.putInt(planCounter);
+    out.putLong(journalPosition);
+    out.putInt(static_cast<int32_t>(facilitiesOptions->size()));
+    for (const FacilityType &facility : *facilitiesOptions)
+        out.putType(facility);
+    out.putInt(static_cast<int32_t>(settlements.size()));
+    for (size_t i = 0; i < settlements.size(); i++)
+    {
+        out.putString(settlements[i].getName());
+        out.putInt(static_cast<int32_t>(settlements[i].getType()));
+    }
+    out.putInt(static_cast<int32_t>(plans.size()));
+    for (size_t i = 0; i < plans.size(); i++)
+    {
+        out.putInt(settlementSlots.find(plans[i].getSettlement().getNameId()));
+        plans[i].save(out);
+        onProgress(i + 1, plans.size());
+    }
+    // actions are kept as their log lines
+    out.putInt(static_cast<int32_t>(actionsLog.size()));
+    for (size_t i = 0; i < actionsLog.size(); i++)
+        out.putString(actionsLog.toString(i));
+    if (!out.finish())
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return std::rename(tempPath.c_str(), filePath.c_str()) == 0;
+}
+
+// replace the state with a checkpoint, nothing changes unless the whole file is good
+bool Simulation::load(const string &filePath)
+{
+    CheckpointReader in(filePath);
+    int loadedPlanCounter = in.getInt();
+    int64_t loadedJournalPosition = in.getLong();
+    vector<FacilityType> loadedOptions;
+    int numOfOptions = in.getCount(sizeof(int32_t));
+    for (int i = 0; (i < numOfOptions) & in.isValid(); i++)
+    {
+        int typeId = in.getTypeId();
+        if (in.isValid())
+            loadedOptions.emplace_back(FacilityType::fromId(typeId));
+    }
+    SharedVector<Settlement> loadedSettlements;
+    NameSlots loadedSettlementSlots;
+    int numOfSettlements = in.getCount(2 * sizeof(int32_t)); // name length and type
+    if (numOfSettlements > 0)
+        NameTable::reserve(numOfSettlements);
+    for (int i = 0; (i < numOfSettlements) & in.isValid(); i++)
+    {
+        string name = in.getString();
+        int type = in.getInt();
+        if ((type < static_cast<int>(SettlementType::VILLAGE)) | (type > static_cast<int>(SettlementType::METROPOLIS)))
+            return false; // the type is the number of construction slots of its plans
+        Settlement *settlement = new Settlement(name, SettlementType(type));
+        if (loadedSettlementSlots.find(settlement->getNameId()) < 0)
+            loadedSettlementSlots.set(settlement->getNameId(), i);
+        loadedSettlements.emplace_back(settlement);
+    }
+    // plans refer to our facilitiesOptions, which is replaced once everything is read
+    SharedVector<Plan> loadedPlans;
+    // settlement, id, policy (at least 8 bytes), status and the counts of constructions and runs, scores
+    int numOfPlans = in.getCount(10 * sizeof(int32_t));
+    for (int i = 0; (i < numOfPlans) & in.isValid(); i++)
+    {
+        int settlementIndex = in.getInt();
+        int planId = in.getInt();
+        SelectionPolicy *policy = SelectionPolicy::load(in);
+        if ((policy == nullptr) | (settlementIndex < 0) | (settlementIndex >= numOfSettlements) | (planId != i))
+        {
+            delete policy;
+            return false;
+        }
+        size_t index = loadedPlans.emplace(planId, loadedSettlements[settlementIndex], policy, facilitiesOptions);
+        if (!loadedPlans.mutableAt(index).loadState(in, loadedOptions.size()))
+            return false;
+    }
+    ActionLog loadedLog;
+    int numOfActions = in.getCount(sizeof(int32_t)); // a log line takes at least its length
+    for (int i = 0; (i < numOfActions) & in.isValid(); i++)
+    {
+        string text = in.getString();
+        if (in.isValid())
+            loadedLog.append(RecordedAction(text).toRecord());
+    }
+    if ((!in.isValid()) | (loadedPlanCounter != numOfPlans))
+        return false;
+    // commit
+    planCounter = loadedPlanCounter;
+    journalPosition = loadedJournalPosition;
+    std::shared_ptr<FacilityCatalogue> options = std::make_shared<FacilityCatalogue>();
+    facilitySlots.clear();
+    for (const FacilityType &facility : loadedOptions)
+    {
+        if (facilitySlots.find(facility.getNameId()) < 0)
+            facilitySlots.set(facility.getNameId(), static_cast<int>(options->size()));
+        options->emplace_back(facility);
+    }
+    facilitiesOptions = options;
+    settlements = move(loadedSettlements);
+    settlementSlots = move(loadedSettlementSlots);
+    plans = move(loadedPlans); // moved, so setCompact below does not copy every plan
+    actionsLog = move(loadedLog);
+    for (size_t i = 0; i < plans.size(); i++)
+        plans.mutableAt(i).setCompact(isCompact);
+    return true;
+}
+
+// replay the journal records after journalPosition, the output of the replayed commands is hidden
+bool Simulation::recover(const string &journalFilePath)
+{
+    int64_t numOfReplayed = 0;
+    bool isContinuous = true;
+    std::streambuf *screen = cout.rdbuf(nullptr);
+    bool isRead = Journal::read(journalFilePath, [this, &numOfReplayed, &isContinuous](int64_t position, const vector<ConfigToken> &command, size_t) {
+        if ((position <= journalPosition) | !isContinuous)
+            return;
+        if (position != journalPosition + 1)
+        {
+            isContinuous = false; // the journal starts after the state, records are missing
+            return;
+        }
+        execute(command);
+        journalPosition = position;
+        numOfReplayed++;
+    });
+    cout.rdbuf(screen);
+    cout.clear();
+    if (!isRead | !isContinuous)
+        return false;
+    cout << "Recovered " << numOfReplayed << " commands from " << journalFilePath << "\n";
+    return true;
+}
+
+// Run a recorded session against this state: a command script or the text printed by 'log'.
+// Nothing is printed per command, the status word of log lines is ignored, consecutive steps
+// run as one step() call and commands that only print are skipped. The report of Close and
+// the replay speed are printed at the end.
+bool Simulation::replay(const string &sessionFilePath)
+{
+    ConfigFile session(sessionFilePath);
+    if (!session.isOpen())
+        return false;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::streambuf *screen = cout.rdbuf(nullptr);
+    vector<ConfigToken> userInput;
+    CommandError commandError = CommandError::NONE;
+    size_t numOfCommands = 0; // applied, merged steps included
+    size_t numOfSkipped = 0; // reports, empty steps and lines that are not a valid command
+    int pendingSteps = 0;
+    while (session.nextLine(userInput))
+    {
+        const ConfigToken &status = userInput.back();
+        if ((userInput.size() > 1) && (status.equals("COMPLETED") | status.equals("ERROR")))
+            userInput.pop_back();
+        if (userInput[0].equals("settlemnet")) // spelling of the actions log
+            userInput[0] = ConfigToken{"settlement", 10};
+        CommandCode code = commandOf(userInput[0]);
+        int numOfSteps = 0;
+        if ((code == CommandCode::STEP) && (userInput.size() > 1) && userInput[1].toInt(numOfSteps))
+        {
+            if (numOfSteps <= 0)
+            {
+                numOfSkipped++; // steps nothing
+                continue;
+            }
+            if (numOfSteps > INT_MAX - pendingSteps)
+            {
+                step(pendingSteps);
+                pendingSteps = 0;
+            }
+            pendingSteps += numOfSteps;
+            numOfCommands++;
+            continue;
+        }
+        if (code == CommandCode::CLOSE)
+            break;
+        if ((code == CommandCode::LOG) | (code == CommandCode::PLAN_STATUS) | (code == CommandCode::BACKUPS) | (code == CommandCode::BGSTATUS))
+        {
+            numOfSkipped++;
+            continue;
+        }
+        if (pendingSteps > 0)
+        {
+            step(pendingSteps);
+            pendingSteps = 0;
+        }
+        BaseAction *currAction = checkAction(userInput, commandError);
+        if (currAction == nullptr)
+        {
+            numOfSkipped++;
+            continue;
+        }
+        currAction->act(*this);
+        delete currAction;
+        numOfCommands++;
+    }
+    if (pendingSteps > 0)
+        step(pendingSteps);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    cout.rdbuf(screen);
+    cout.clear();
+    Close().act(*this);
+    double seconds = elapsed.count();
+    cout << "Replayed " << numOfCommands << " commands in " << seconds << " s";
+    if (seconds > 0)
+        cout << " (" << static_cast<long long>(numOfCommands / seconds) << " commands/s)";
+    cout << "\n";
+    cout << "Skipped " << numOfSkipped << " lines" << "\n";
+    return true;
 }
\ No newline at end of file
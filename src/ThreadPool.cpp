@@ -0,0 +1,145 @@
+#include "ThreadPool.h"
+#include <algorithm> // For std::min
+
+ThreadPool::WorkQueue::WorkQueue() :
+lock(),
+chunks() {}
+
+// constructor
+ThreadPool::ThreadPool(int numOfThreads) :
+numOfThreads(numOfThreads < 1 ? 1 : numOfThreads),
+workers(),
+queues(),
+poolLock(),
+wakeUp(),
+allDone(),
+currTask(nullptr),
+pendingChunks(0),
+generation(0),
+isStopping(false)
+{
+    for (int i = 0; i < this->numOfThreads; i++)
+        queues.emplace_back(new WorkQueue());
+    // the calling thread acts as worker 0
+    for (int i = 1; i < this->numOfThreads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+// destructor
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        isStopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+    for (WorkQueue *queue : queues)
+        delete queue;
+    queues.clear();
+}
+
+int ThreadPool::getNumOfThreads() const
+{
+    return numOfThreads;
+}
+
+int ThreadPool::getMaxNumOfThreads()
+{
+    return 8 * std::max(1u, std::thread::hardware_concurrency());
+}
+
+// run task(begin, end) over [0, size) and wait for all chunks to finish
+void ThreadPool::parallelFor(size_t size, size_t chunkSize, const std::function<void(size_t, size_t)> &task)
+{
+    if (chunkSize == 0)
+        chunkSize = 1;
+    if ((numOfThreads == 1) | (size <= chunkSize))
+    {
+        if (size > 0)
+            task(0, size);
+        return;
+    }
+    size_t numOfChunks = (size + chunkSize - 1) / chunkSize;
+    // publish the task before any chunk becomes visible to a worker
+    currTask = &task;
+    pendingChunks = numOfChunks;
+    for (size_t i = 0; i < numOfChunks; i++)
+    {
+        size_t begin = i * chunkSize;
+        size_t end = std::min(size, begin + chunkSize);
+        WorkQueue *queue = queues[i % queues.size()];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->chunks.emplace_back(begin, end);
+    }
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        generation++;
+    }
+    wakeUp.notify_all();
+    runChunks(0);
+    std::unique_lock<std::mutex> guard(poolLock);
+    allDone.wait(guard, [this] { return pendingChunks == 0; });
+    currTask = nullptr;
+}
+
+void ThreadPool::workerLoop(int workerId)
+{
+    size_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(poolLock);
+            wakeUp.wait(guard, [this, seenGeneration] { return isStopping || generation != seenGeneration; });
+            if (isStopping)
+                return;
+            seenGeneration = generation;
+        }
+        runChunks(workerId);
+    }
+}
+
+void ThreadPool::runChunks(int workerId)
+{
+    std::pair<size_t, size_t> chunk;
+    while (popChunk(workerId, chunk) || stealChunk(workerId, chunk))
+    {
+        (*currTask)(chunk.first, chunk.second);
+        if (--pendingChunks == 0)
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            allDone.notify_all();
+        }
+    }
+}
+
+// own queue is consumed from the front
+bool ThreadPool::popChunk(int workerId, std::pair<size_t, size_t> &chunk)
+{
+    WorkQueue *queue = queues[workerId];
+    std::lock_guard<std::mutex> guard(queue->lock);
+    if (queue->chunks.empty())
+        return false;
+    chunk = queue->chunks.front();
+    queue->chunks.pop_front();
+    return true;
+}
+
+// other queues are robbed from the back
+bool ThreadPool::stealChunk(int workerId, std::pair<size_t, size_t> &chunk)
+{
+    for (int i = 1; i < numOfThreads; i++)
+    {
+        WorkQueue *victim = queues[(workerId + i) % numOfThreads];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (!victim->chunks.empty())
+        {
+            chunk = victim->chunks.back();
+            victim->chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
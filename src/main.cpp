@@ -1,19 +1,115 @@
 #include "Simulation.h"
+#include "BackgroundSave.h"
+#include "Journal.h"
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
+static int usage(){
+    cout << "usage: simulation <config_path> [--threads <num_of_threads>] [--compact] [--script <commands_path>]" << endl;
+    cout << "                  [--journal <journal_path> [--journal-window <milliseconds>] [--recover]]" << endl;
+    cout << "       simulation <config_path> --replay <session_path> [--threads <num_of_threads>] [--compact]" << endl;
+    cout << "       simulation --compile-config <config_path> <catalogue_path> [--threads <num_of_threads>]" << endl;
+    return 0;
+}
+
+// parse a text config once and store it as a binary catalogue that starts without parsing
+static int compileConfig(const string &configurationFile, const string &catalogueFile, int numOfThreads){
+    Simulation simulation(configurationFile, numOfThreads);
+    if(!simulation.save(catalogueFile)){
+        cout << "Error: Cannot save checkpoint" << endl;
+        return 1;
+    }
+    return 0;
+}
+
 int main(int argc, char** argv){
-    if(argc!=2){
-        cout << "usage: simulation <config_path>" << endl;
-        return 0;
+    if(argc<2)
+        return usage();
+    bool isCompiling = string(argv[1])=="--compile-config";
+    if(isCompiling & (argc<4))
+        return usage();
+    string configurationFile = isCompiling ? argv[2] : argv[1];
+    int numOfThreads = 1;
+    bool isCompact = false;
+    string scriptFile;
+    string replayFile;
+    string journalFile;
+    int journalWindow = 10; // milliseconds between group commits
+    bool isRecovering = false;
+    for(int i=isCompiling ? 4 : 2; i<argc; i++){
+        string flag = argv[i];
+        if((flag=="--threads") & (i+1<argc) && atoi(argv[i+1])>0 && atoi(argv[i+1])<=ThreadPool::getMaxNumOfThreads())
+            numOfThreads = atoi(argv[++i]);
+        else if(flag=="--compact")
+            isCompact = true;
+        else if((flag=="--script") & (i+1<argc))
+            scriptFile = argv[++i];
+        else if((flag=="--replay") & (i+1<argc))
+            replayFile = argv[++i];
+        else if((flag=="--journal") & (i+1<argc))
+            journalFile = argv[++i];
+        else if((flag=="--journal-window") & (i+1<argc) && atoi(argv[i+1])>=0)
+            journalWindow = atoi(argv[++i]);
+        else if(flag=="--recover")
+            isRecovering = true;
+        else
+            return usage();
+    }
+    if(isRecovering & journalFile.empty())
+        return usage();
+    if(isCompiling)
+        return compileConfig(configurationFile, argv[3], numOfThreads);
+    // a script runs as a batch: no prompts, one big output buffer flushed at exit,
+    // and input read in large blocks. '--script -' reads the script from stdin
+    bool isBatch = !scriptFile.empty() | !replayFile.empty();
+    static char outputBuffer[1 << 20]; // static, cout is flushed after main returns
+    if(isBatch){
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        cout.rdbuf()->pubsetbuf(outputBuffer, sizeof(outputBuffer));
+    }
+    Simulation simulation(configurationFile, numOfThreads);
+    simulation.setCompactMode(isCompact);
+    // recovery replays the journal on top of the checkpoint, then keeps appending to it
+    if(isRecovering && !simulation.recover(journalFile)){
+        cout << "Error: Cannot recover from " << journalFile << endl;
+        return 1;
+    }
+    if(!journalFile.empty() && !journal.open(journalFile, simulation.getJournalPosition(), isRecovering, journalWindow)){
+        cout << "Error: Cannot open " << journalFile << endl;
+        return 1;
+    }
+    if(!replayFile.empty()){
+        if(!simulation.replay(replayFile)){
+            cout << "Error: Cannot open " << replayFile << endl;
+            return 1;
+        }
+    }
+    else if(isBatch & (scriptFile!="-")){
+        vector<char> inputBuffer(1 << 20);
+        ifstream script;
+        script.rdbuf()->pubsetbuf(inputBuffer.data(), inputBuffer.size());
+        script.open(scriptFile);
+        if(!script.is_open()){
+            cout << "Error: Cannot open " << scriptFile << endl;
+            return 1;
+        }
+        simulation.start(script, true);
     }
-    string configurationFile = argv[1];
-    Simulation simulation(configurationFile);
-    simulation.start();
+    else
+        simulation.start(cin, isBatch);
+    backgroundSave.wait(); // let a running 'bgsave' finish its file
+    journal.close(); // the last group commit
     if(backup!=nullptr){
     	delete backup;
     	backup = nullptr;
     }
+    for(const pair<const string, Simulation*> &namedBackup : namedBackups)
+    	delete namedBackup.second;
+    namedBackups.clear();
     return 0;
 }
\ No newline at end of file
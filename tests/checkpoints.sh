@@ -0,0 +1,52 @@
+#!/bin/sh
+# Loads truncated and corrupted checkpoints.
+# usage: tests/checkpoints.sh <simulation_binary> [num_of_files]
+# Saves a checkpoint of a stepped config, then feeds copies with one byte changed or
+# with the end cut off to 'load'. Every load has to finish within 10 seconds without
+# crashing, and a load that fails has to leave the simulation as it was.
+set -e
+sim=${1:?usage: tests/checkpoints.sh <simulation_binary> [num_of_files]}
+numOfFiles=${2:-200}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+awk 'BEGIN {
+    srand(1);
+    for (i = 0; i < 30; i++) print "settlement S" i, i % 3;
+    for (i = 0; i < 40; i++) print "facility F" i, i % 3, 1 + int(rand() * 5), int(rand() * 6), int(rand() * 6), int(rand() * 6);
+    split("nve bal eco env", policy, " ");
+    for (i = 0; i < 200; i++) print "plan S" (i % 30), policy[1 + i % 4];
+}' > "$work/config.txt"
+printf 'step 3000\nsave %s\nclose\n' "$work/good.ckpt" > "$work/save.txt"
+"$sim" "$work/config.txt" --compact --script "$work/save.txt" > /dev/null
+size=$(wc -c < "$work/good.ckpt")
+printf 'close\n' > "$work/close.txt"
+"$sim" "$work/config.txt" --script "$work/close.txt" > "$work/expected.txt"
+printf 'load %s\nclose\n' "$work/bad.ckpt" > "$work/load.txt"
+
+# even files change one byte, odd files are truncated
+awk -v files="$numOfFiles" -v size="$size" 'BEGIN {
+    srand(2);
+    for (i = 0; i < files; i++) print i % 2, int(rand() * size), 1 + int(rand() * 255);
+}' > "$work/cases.txt"
+numOfRejected=0
+while read -r isTruncated offset value; do
+    cp "$work/good.ckpt" "$work/bad.ckpt"
+    if [ "$isTruncated" -eq 1 ]; then
+        truncate -s "$offset" "$work/bad.ckpt"
+    else
+        old=$(od -An -tu1 -j "$offset" -N1 "$work/good.ckpt")
+        printf "\\$(printf '%03o' $(( (old ^ value) & 255 )))" | dd of="$work/bad.ckpt" bs=1 seek="$offset" conv=notrunc 2> /dev/null
+    fi
+    status=0
+    timeout 10 "$sim" "$work/config.txt" --script "$work/load.txt" > "$work/out.txt" 2>&1 || status=$?
+    if [ "$status" -ne 0 ]; then
+        echo "truncated=$isTruncated offset=$offset value=$value: exit status $status"
+        exit 1
+    fi
+    if grep -q 'Cannot load checkpoint' "$work/out.txt"; then
+        numOfRejected=$((numOfRejected + 1))
+        grep -v 'Cannot load checkpoint' "$work/out.txt" | cmp -s - "$work/expected.txt" || { echo "truncated=$isTruncated offset=$offset value=$value: a failed load changed the simulation"; exit 1; }
+    fi
+done < "$work/cases.txt"
+echo "checkpoints: $numOfFiles loaded, $numOfRejected rejected, size $size"